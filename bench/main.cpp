@@ -0,0 +1,381 @@
+#include <NazaraImgui/ImguiDrawListCompiler.hpp>
+
+#include <NZSL/Parser.hpp>
+#include <NZSL/Serializer.hpp>
+#include <NZSL/Ast/AstSerializer.hpp>
+#include <NZSL/Ast/ConstantPropagationVisitor.hpp>
+#include <NZSL/Ast/EliminateUnusedPassVisitor.hpp>
+#include <NZSL/Ast/SanitizeVisitor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    NazaraImgui-bench
+    Times the CPU stages of ImguiDrawer on synthetic draw data, without any render device:
+    - prepare: placing, fingerprinting and uploading draw lists (into host memory standing for the mapped gpu buffers)
+    - commands: compiling the draw command stream
+    And the startup cost of loading ImguiDrawer shaders, parsed from source and optimized (what the runtime used to do)
+    or deserialized from the precompiled modules, which are already optimized. Both are sanitized, as the shader writer does.
+    Heap allocations made by both stages are counted too, a steady-state single-threaded frame has to make none
+    and the benchmark fails if one does (the task scheduler used by multithreaded modes allocates on its own).
+*/
+
+namespace
+{
+	std::atomic_size_t s_allocationCount = 0;
+
+	const std::uint8_t s_texturedShaderBinary[] = {
+#include "Textured.nzslb.h"
+	};
+
+	const std::uint8_t s_untexturedShaderBinary[] = {
+#include "Untextured.nzslb.h"
+	};
+}
+
+void* operator new(std::size_t size)
+{
+	s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+namespace
+{
+	struct Scenario
+	{
+		const char* name;
+		int windowCount;
+		int verticesPerWindow;
+		int textureCount;
+		int clipRectsPerWindow;
+	};
+
+	constexpr Scenario s_scenarios[] = {
+		{ "small",        4,   2'000,  1,   4 },
+		{ "docked",       32,  4'000,  4,   16 },
+		{ "text-heavy",   16,  40'000, 2,   8 },
+		{ "many-clips",   32,  4'000,  4,   128 },
+		{ "many-windows", 128, 1'000,  8,   8 },
+		{ "huge",         64,  20'000, 16,  32 }
+	};
+
+	struct Stats
+	{
+		double median;
+		double min;
+		double p90;
+	};
+
+	class SyntheticDrawData
+	{
+	public:
+		SyntheticDrawData(const Scenario& scenario, unsigned int seed)
+		{
+			std::mt19937 rng(seed);
+			std::uniform_real_distribution<float> position(0.f, 1920.f);
+
+			for (int windowIndex = 0; windowIndex < scenario.windowCount; ++windowIndex)
+			{
+				auto& drawList = m_drawLists.emplace_back(std::make_unique<ImDrawList>(nullptr));
+
+				// quads are split between clip rects, each command references its own vertices through VtxOffset
+				int quadCount = scenario.verticesPerWindow / 4;
+				int quadsPerCommand = std::max(quadCount / scenario.clipRectsPerWindow, 1);
+
+				for (int quadIndex = 0; quadIndex < quadCount; quadIndex += quadsPerCommand)
+				{
+					int commandQuadCount = std::min(quadsPerCommand, quadCount - quadIndex);
+					int commandIndex = quadIndex / quadsPerCommand;
+
+					ImDrawCmd cmd;
+					cmd.ClipRect = ImVec4(float(commandIndex % 16) * 8.f, 0.f, 1920.f - float(commandIndex % 16) * 8.f, 1080.f);
+					cmd.TextureId = reinterpret_cast<ImTextureID>(std::uintptr_t(1 + (windowIndex + commandIndex) % scenario.textureCount));
+					cmd.VtxOffset = static_cast<unsigned int>(drawList->VtxBuffer.size());
+					cmd.IdxOffset = static_cast<unsigned int>(drawList->IdxBuffer.size());
+					cmd.ElemCount = static_cast<unsigned int>(commandQuadCount * 6);
+					cmd.UserCallback = nullptr;
+					drawList->CmdBuffer.push_back(cmd);
+
+					for (int i = 0; i < commandQuadCount; ++i)
+					{
+						float x = position(rng);
+						float y = position(rng);
+						ImU32 color = static_cast<ImU32>(rng());
+
+						drawList->VtxBuffer.push_back(ImDrawVert{ ImVec2(x, y), ImVec2(0.f, 0.f), color });
+						drawList->VtxBuffer.push_back(ImDrawVert{ ImVec2(x + 8.f, y), ImVec2(1.f, 0.f), color });
+						drawList->VtxBuffer.push_back(ImDrawVert{ ImVec2(x + 8.f, y + 8.f), ImVec2(1.f, 1.f), color });
+						drawList->VtxBuffer.push_back(ImDrawVert{ ImVec2(x, y + 8.f), ImVec2(0.f, 1.f), color });
+
+						ImDrawIdx base = static_cast<ImDrawIdx>(i * 4);
+						for (ImDrawIdx index : { 0, 1, 2, 0, 2, 3 })
+							drawList->IdxBuffer.push_back(static_cast<ImDrawIdx>(base + index));
+					}
+				}
+
+				m_drawListPointers.push_back(drawList.get());
+				m_drawData.TotalVtxCount += drawList->VtxBuffer.size();
+				m_drawData.TotalIdxCount += drawList->IdxBuffer.size();
+			}
+
+			m_drawData.Valid = true;
+			m_drawData.CmdListsCount = int(m_drawListPointers.size());
+			m_drawData.CmdLists = m_drawListPointers.data();
+		}
+
+		// Alters one vertex per draw list, so they all have to be uploaded again
+		void Touch()
+		{
+			for (ImDrawList* drawList : m_drawListPointers)
+			{
+				if (!drawList->VtxBuffer.empty())
+					drawList->VtxBuffer[0].col++;
+			}
+		}
+
+		const ImDrawData& GetDrawData() const { return m_drawData; }
+
+	private:
+		std::vector<std::unique_ptr<ImDrawList>> m_drawLists;
+		std::vector<ImDrawList*> m_drawListPointers;
+		ImDrawData m_drawData;
+	};
+
+	Stats ComputeStats(std::vector<double>& samples)
+	{
+		std::sort(samples.begin(), samples.end());
+
+		Stats stats;
+		stats.min = samples.front();
+		stats.median = samples[samples.size() / 2];
+		stats.p90 = samples[std::min(samples.size() * 9 / 10, samples.size() - 1)];
+
+		return stats;
+	}
+
+	std::string ReadShaderSource(const char* fileName)
+	{
+		std::ifstream file(std::string(NAZARA_IMGUI_BENCH_SHADER_DIR) + "/" + fileName, std::ios::binary);
+		if (!file)
+		{
+			std::fprintf(stderr, "failed to open %s\n", fileName);
+			std::exit(EXIT_FAILURE);
+		}
+
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void PrintStats(const char* scenario, const char* mode, const char* stage, const Stats& stats, double allocationsPerFrame)
+	{
+		std::printf("%-14s %-14s %-10s %12.2f %12.2f %12.2f %12.2f\n", scenario, mode, stage, stats.median, stats.min, stats.p90, allocationsPerFrame);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned int iterationCount = 200;
+	unsigned int warmupCount = 20;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+			iterationCount = std::max(std::atoi(argv[++i]), 1);
+		else if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+			warmupCount = std::max(std::atoi(argv[++i]), 0);
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--iterations N] [--warmup N]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::printf("%-14s %-14s %-10s %12s %12s %12s %12s\n", "scenario", "mode", "stage", "median(us)", "min(us)", "p90(us)", "allocs");
+
+	bool allocationCheckFailed = false;
+
+	for (const Scenario& scenario : s_scenarios)
+	{
+		SyntheticDrawData syntheticData(scenario, 42);
+		const ImDrawData& drawData = syntheticData.GetDrawData();
+
+		std::vector<ImDrawVert> vertices(drawData.TotalVtxCount);
+		std::vector<ImDrawIdx> indices(drawData.TotalIdxCount);
+
+		struct Mode
+		{
+			const char* name;
+			bool dirty;
+			bool parallel;
+			bool allocationFree;
+		};
+
+		constexpr Mode modes[] = {
+			{ "static",         false, false, true },
+			{ "dynamic",        true,  false, true },
+			{ "dynamic-mt",     true,  true,  false }
+		};
+
+		for (const Mode& mode : modes)
+		{
+			Nz::ImguiDrawListCompiler compiler;
+			compiler.SetParallelThreshold((mode.parallel) ? 0 : std::numeric_limits<std::size_t>::max());
+
+			Nz::ImguiDrawListCompiler::UploadCache uploadCache;
+
+			// textures ids are fake, map them to as many fake bindings
+			auto resolveDrawState = [](ImTextureID textureId) -> Nz::ImguiDrawListCompiler::DrawState
+			{
+				return { nullptr, nullptr, reinterpret_cast<const Nz::ShaderBinding*>(textureId) };
+			};
+
+			std::vector<double> prepareSamples;
+			std::vector<double> commandSamples;
+			prepareSamples.reserve(iterationCount);
+			commandSamples.reserve(iterationCount);
+
+			std::size_t prepareAllocationCount = 0;
+			std::size_t commandAllocationCount = 0;
+
+			for (unsigned int iteration = 0; iteration < warmupCount + iterationCount; ++iteration)
+			{
+				if (mode.dirty)
+					syntheticData.Touch();
+
+				std::size_t startAllocationCount = s_allocationCount;
+				auto start = std::chrono::steady_clock::now();
+
+				if (compiler.PrepareDrawLists(drawData, uploadCache) > 0)
+					compiler.UploadDrawLists(vertices.data(), indices.data(), uploadCache);
+
+				auto prepared = std::chrono::steady_clock::now();
+				std::size_t preparedAllocationCount = s_allocationCount;
+
+				compiler.CompileCommands(resolveDrawState);
+
+				auto compiled = std::chrono::steady_clock::now();
+				std::size_t compiledAllocationCount = s_allocationCount;
+
+				if (iteration >= warmupCount)
+				{
+					prepareSamples.push_back(std::chrono::duration<double, std::micro>(prepared - start).count());
+					commandSamples.push_back(std::chrono::duration<double, std::micro>(compiled - prepared).count());
+
+					prepareAllocationCount += preparedAllocationCount - startAllocationCount;
+					commandAllocationCount += compiledAllocationCount - preparedAllocationCount;
+				}
+			}
+
+			PrintStats(scenario.name, mode.name, "prepare", ComputeStats(prepareSamples), double(prepareAllocationCount) / iterationCount);
+			PrintStats(scenario.name, mode.name, "commands", ComputeStats(commandSamples), double(commandAllocationCount) / iterationCount);
+
+			if (mode.allocationFree && (prepareAllocationCount > 0 || commandAllocationCount > 0))
+			{
+				std::fprintf(stderr, "%s %s: %zu heap allocations after warm-up (prepare: %zu, commands: %zu), expected none\n", scenario.name, mode.name, prepareAllocationCount + commandAllocationCount, prepareAllocationCount, commandAllocationCount);
+				allocationCheckFailed = true;
+			}
+		}
+	}
+
+	struct Shader
+	{
+		const char* name;
+		const char* sourceFile;
+		const std::uint8_t* binary;
+		std::size_t binarySize;
+	};
+
+	const Shader shaders[] = {
+		{ "textured",   "Textured.nzsl",   s_texturedShaderBinary,   sizeof(s_texturedShaderBinary) },
+		{ "untextured", "Untextured.nzsl", s_untexturedShaderBinary, sizeof(s_untexturedShaderBinary) }
+	};
+
+	for (const Shader& shader : shaders)
+	{
+		std::string source = ReadShaderSource(shader.sourceFile);
+
+		std::vector<double> parseSamples;
+		std::vector<double> loadSamples;
+		parseSamples.reserve(iterationCount);
+		loadSamples.reserve(iterationCount);
+
+		for (unsigned int iteration = 0; iteration < warmupCount + iterationCount; ++iteration)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			// states.optimize made the shader writer run these passes on the sanitized module
+			nzsl::Ast::ModulePtr parsedModule = nzsl::Ast::Sanitize(*nzsl::Parse(source));
+			parsedModule = nzsl::Ast::PropagateConstants(*parsedModule);
+			parsedModule = nzsl::Ast::EliminateUnusedPass(*parsedModule);
+
+			auto parsed = std::chrono::steady_clock::now();
+
+			nzsl::Deserializer deserializer(shader.binary, shader.binarySize);
+			nzsl::Ast::ModulePtr loadedModule = nzsl::Ast::Sanitize(*nzsl::Ast::DeserializeShader(deserializer));
+
+			auto loaded = std::chrono::steady_clock::now();
+
+			if (!parsedModule || !loadedModule)
+			{
+				std::fprintf(stderr, "failed to load %s shader\n", shader.name);
+				return EXIT_FAILURE;
+			}
+
+			if (iteration >= warmupCount)
+			{
+				parseSamples.push_back(std::chrono::duration<double, std::micro>(parsed - start).count());
+				loadSamples.push_back(std::chrono::duration<double, std::micro>(loaded - parsed).count());
+			}
+		}
+
+		Stats parseStats = ComputeStats(parseSamples);
+		Stats loadStats = ComputeStats(loadSamples);
+
+		std::printf("%-14s %-14s %-10s %12.2f %12.2f %12.2f %12s\n", "shaders", shader.name, "parse+opt", parseStats.median, parseStats.min, parseStats.p90, "-");
+		std::printf("%-14s %-14s %-10s %12.2f %12.2f %12.2f %12s\n", "shaders", shader.name, "load", loadStats.median, loadStats.min, loadStats.p90, "-");
+	}
+
+	return (allocationCheckFailed) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,19 @@
+option("bench")
+	set_default(false)
+	set_showmenu(true)
+	set_description("Build benchmarks")
+option_end()
+
+if has_config("bench") then
+	target("NazaraImgui-bench")
+		set_group("Benchmarks")
+		set_kind("binary")
+		add_files("main.cpp")
+		add_deps("NazaraImgui")
+
+		-- shader parsing is compared to loading the precompiled modules
+		add_rules("compile.shaders")
+		add_files("../src/NazaraImgui/Resources/*.nzsl")
+		add_defines("NAZARA_IMGUI_BENCH_SHADER_DIR=\"" .. path.unix(path.join(os.projectdir(), "src", "NazaraImgui", "Resources")) .. "\"")
+		set_rundir(".")
+end
@@ -85,28 +85,32 @@ int WinMain(int argc, char* argv[])
 		float deltaTime = updateClock.GetElapsedTime().AsSeconds();
 		Nz::Imgui::Instance()->Update(deltaTime);
 
-		if (ImGui::BeginMainMenuBar())
+		// in idle mode Update may not start an imgui frame, imgui functions can't be called then (handlers are only run when it did)
+		if (!Nz::Imgui::Instance()->IsIdle())
 		{
-			if (ImGui::BeginMenu("Test"))
+			if (ImGui::BeginMainMenuBar())
 			{
-				if (ImGui::MenuItem("Test", "Ctrl+O"))
-					printf("test\n");
-				ImGui::EndMenu();
+				if (ImGui::BeginMenu("Test"))
+				{
+					if (ImGui::MenuItem("Test", "Ctrl+O"))
+						printf("test\n");
+					ImGui::EndMenu();
+				}
+				ImGui::EndMainMenuBar();
 			}
-			ImGui::EndMainMenuBar();
-		}
-		if (ImGui::BeginPopupModal("toto"))
-		{
-			ImGui::EndPopup();
+			if (ImGui::BeginPopupModal("toto"))
+			{
+				ImGui::EndPopup();
+			}
+			ImGui::Begin("Loop Window");
+			ImGui::Image(logo.get());
+			ImGui::ImageButton(logo.get());
+			ImGui::SliderFloat("test", &val, 0, 10);
+			ImGui::ColorPicker4("Color", color, ImGuiColorEditFlags_PickerHueWheel | ImGuiColorEditFlags_DisplayRGB | ImGuiColorEditFlags_InputRGB);
+
+			ImGui::InputFloat4("value from 2nd window", mywindow.values, "%.3f", ImGuiInputTextFlags_ReadOnly);
+			ImGui::End();
 		}
-		ImGui::Begin("Loop Window");
-		ImGui::Image(logo.get());
-		ImGui::ImageButton(logo.get());
-		ImGui::SliderFloat("test", &val, 0, 10);
-		ImGui::ColorPicker4("Color", color, ImGuiColorEditFlags_PickerHueWheel | ImGuiColorEditFlags_DisplayRGB | ImGuiColorEditFlags_InputRGB);
-		
-		ImGui::InputFloat4("value from 2nd window", mywindow.values, "%.3f", ImGuiInputTextFlags_ReadOnly);
-		ImGui::End();
 
 		Nz::Imgui::Instance()->Render(windowSwapchain.GetSwapchain(), frame);
 
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <NazaraImgui/Config.hpp>
+
+#include <imgui.h>
+
+#include <memory>
+#include <vector>
+
+/*
+    ImguiDrawDataSnapshot.hpp
+    Copy of a frame's draw data which stays valid while imgui builds the next frame.
+    Geometry and commands are taken by swapping buffers with imgui's draw lists, nothing is copied.
+    What the drawer reads from the imgui context is captured too, so it never has to access it.
+*/
+
+namespace Nz
+{
+	class NAZARA_IMGUI_API ImguiDrawDataSnapshot
+	{
+	public:
+		ImguiDrawDataSnapshot() = default;
+		ImguiDrawDataSnapshot(const ImguiDrawDataSnapshot&) = delete;
+		ImguiDrawDataSnapshot(ImguiDrawDataSnapshot&&) noexcept = default;
+		~ImguiDrawDataSnapshot() = default;
+
+		ImguiDrawDataSnapshot& operator=(const ImguiDrawDataSnapshot&) = delete;
+		ImguiDrawDataSnapshot& operator=(ImguiDrawDataSnapshot&&) noexcept = default;
+
+		// Takes the content of drawData's draw lists, which are left with the previous content of this snapshot and must not be drawn anymore
+		// Must be called on the thread owning the current imgui context
+		void Capture(ImDrawData& drawData);
+
+		// nullptr until something was captured
+		inline ImDrawData* GetDrawData() { return (m_drawData.Valid) ? &m_drawData : nullptr; }
+		// Font atlas texture when the draw data was captured
+		inline ImTextureID GetFontTextureId() const { return m_fontTextureId; }
+
+	private:
+		ImDrawData m_drawData;
+		ImTextureID m_fontTextureId = nullptr;
+		// draw lists are kept across captures, so their buffers only grow
+		std::vector<std::unique_ptr<ImDrawList>> m_drawLists;
+		std::vector<ImDrawList*> m_drawListPointers;
+	};
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <NazaraImgui/Config.hpp>
+
+#include <Nazara/Core/TaskScheduler.hpp>
+#include <Nazara/Math/Rect.hpp>
+#include <NazaraUtils/FunctionRef.hpp>
+
+#include <imgui.h>
+
+#include <memory>
+#include <vector>
+
+/*
+    ImguiDrawListCompiler.hpp
+    CPU side of ImguiDrawer: places draw lists in the vertex/index buffers, uploads the ones which changed
+    and compiles their commands into a flat stream. It doesn't depend on a render device.
+*/
+
+namespace Nz
+{
+	class RenderPipeline;
+	class ShaderBinding;
+
+	class NAZARA_IMGUI_API ImguiDrawListCompiler
+	{
+	public:
+		// Where a draw list was last uploaded in a buffer set, and a fingerprint of its content
+		struct UploadedDrawList
+		{
+			bool valid = false;
+			UInt64 fingerprint;
+			std::size_t vertexOffset;
+			std::size_t vertexCount;
+			std::size_t indexOffset;
+			std::size_t indexCount;
+		};
+		using UploadCache = std::vector<UploadedDrawList>;
+
+		// State a command has to be drawn with
+		struct DrawState
+		{
+			const RenderPipeline* pipeline;
+			const ShaderBinding* uboBinding;
+			const ShaderBinding* textureBinding;
+		};
+		// non-owning so resolving doesn't allocate, the callable only has to outlive CompileCommands
+		using DrawStateResolver = FunctionRef<DrawState(ImTextureID textureId)>;
+
+		// Draw command with its state already resolved, only states flagged in stateChanges have to be bound
+		struct DrawCommand
+		{
+			enum : UInt8
+			{
+				PipelineChange       = 1 << 0,
+				TextureBindingChange = 1 << 1,
+				ScissorChange        = 1 << 2,
+				VertexBufferChange   = 1 << 3
+			};
+
+			const RenderPipeline* pipeline;
+			const ShaderBinding* uboBinding;
+			const ShaderBinding* textureBinding;
+			Recti scissor;
+			UInt64 vertexBufferOffset;
+			UInt32 firstIndex;
+			UInt32 indexCount;
+			UInt8 stateChanges;
+		};
+
+		// What the compiled command stream binds and draws
+		struct CommandStats
+		{
+			std::size_t drawCallCount = 0;
+			std::size_t pipelineChangeCount = 0;
+			std::size_t shaderBindingChangeCount = 0;
+			std::size_t scissorChangeCount = 0;
+			std::size_t vertexBufferChangeCount = 0;
+			std::size_t skippedStateChangeCount = 0;
+		};
+
+		ImguiDrawListCompiler();
+		ImguiDrawListCompiler(const ImguiDrawListCompiler&) = delete;
+		ImguiDrawListCompiler(ImguiDrawListCompiler&&) noexcept = default;
+		~ImguiDrawListCompiler();
+
+		ImguiDrawListCompiler& operator=(const ImguiDrawListCompiler&) = delete;
+		ImguiDrawListCompiler& operator=(ImguiDrawListCompiler&&) noexcept = default;
+
+		// Places draw lists one after another and finds which ones differ from what the cache says was uploaded, returns their count
+		std::size_t PrepareDrawLists(const ImDrawData& drawData, UploadCache& uploadCache);
+		// Copies dirty draw lists into the vertex and index memory (sized for the whole draw data) and updates the cache
+		void UploadDrawLists(void* vertices, void* indices, UploadCache& uploadCache);
+		// Builds the command stream of the prepared draw lists, clip rects are scaled to framebuffer coordinates by clipScale
+		void CompileCommands(DrawStateResolver resolveDrawState, const ImVec2& clipScale = ImVec2(1.f, 1.f));
+
+		void Clear();
+
+		inline const std::vector<DrawCommand>& GetCommands() const { return m_drawCommands; }
+		inline const CommandStats& GetCommandStats() const { return m_commandStats; }
+		// Size in bytes of the vertices and indices of the draw lists found dirty by the last PrepareDrawLists
+		inline std::size_t GetDirtyGeometrySize() const { return m_dirtyGeometrySize; }
+		inline std::size_t GetGeometrySize() const { return m_geometrySize; }
+		// Fingerprint of the geometry and commands of all draw lists prepared last, equal fingerprints mean the frames draw the same
+		inline UInt64 GetFrameFingerprint() const { return m_frameFingerprint; }
+
+		// Draw lists are hashed and uploaded by worker threads when a frame holds at least this many bytes of geometry
+		inline std::size_t GetParallelThreshold() const { return m_parallelThreshold; }
+		inline void SetParallelThreshold(std::size_t threshold) { m_parallelThreshold = threshold; }
+
+		static constexpr std::size_t DefaultParallelThreshold = 512 * 1024;
+
+	private:
+		template<typename F> void DispatchDrawListRanges(F&& func);
+
+		// Per-frame draw list state, shared by the workers
+		struct PreparedDrawList
+		{
+			const ImDrawList* drawList;
+			std::size_t vertexOffset;
+			std::size_t indexOffset;
+			std::size_t geometrySize;
+			UInt64 fingerprint;
+			UInt64 commandFingerprint;
+			bool dirty;
+		};
+		struct TaskRange
+		{
+			std::size_t first;
+			std::size_t last;
+		};
+		std::vector<PreparedDrawList> m_preparedDrawLists;
+		std::vector<TaskRange> m_taskRanges;
+		std::vector<DrawCommand> m_drawCommands;
+		std::unique_ptr<TaskScheduler> m_taskScheduler;
+		TaskScheduler* m_activeTaskScheduler;
+		UInt64 m_frameFingerprint;
+		std::size_t m_dirtyGeometrySize;
+		std::size_t m_geometrySize;
+		std::size_t m_parallelThreshold;
+		CommandStats m_commandStats;
+	};
+}
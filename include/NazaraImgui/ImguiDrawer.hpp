@@ -1,53 +1,173 @@
 #pragma once
 
 #include <NazaraImgui/Config.hpp>
+#include <NazaraImgui/ImguiDrawListCompiler.hpp>
+#include <NazaraImgui/ImguiLayerState.hpp>
 
+#include <Nazara/Core/Enums.hpp>
+#include <Nazara/Math/Vector2.hpp>
+#include <Nazara/Math/Vector3.hpp>
 #include <Nazara/Renderer/ShaderBinding.hpp>
+#include <NZSL/Ast/Module.hpp>
 
 #include <imgui.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <vector>
+
 namespace Nz
 {
 	class CommandBufferBuilder;
+	class Framebuffer;
 	class RenderBuffer;
 	class RenderDevice;
+	class RenderPass;
 	class RenderResources;
 	class RenderPipeline;
+	class Texture;
+	class VertexDeclaration;
 
 	class NAZARA_IMGUI_API ImguiDrawer
 	{
 	public:
+		struct FrameStats;
+		struct TextureBindingCacheStats;
+
 		ImguiDrawer(RenderDevice& renderDevice);
 		ImguiDrawer(const ImguiDrawer&) = delete;
-		ImguiDrawer(ImguiDrawer&&) noexcept = default;
+		ImguiDrawer(ImguiDrawer&&) noexcept;
 		~ImguiDrawer();
 
 		ImguiDrawer& operator=(const ImguiDrawer&) = delete;
 		ImguiDrawer& operator=(ImguiDrawer&&) = delete;
 
 		void Prepare(RenderResources& renderFrame);
+		// Prepares the given draw data (such as a snapshot) instead of imgui's current one, it's only read during this call
+		// The imgui context isn't accessed, so this can run while another thread builds the next frame
+		void Prepare(RenderResources& renderFrame, ImDrawData* drawData, ImTextureID fontTextureId);
 
 		void Reset(RenderResources& renderFrame);
 
 		void Draw(CommandBufferBuilder& builder);
+
+		// Keeps the last prepared frame for this one without reading any draw data, it then counts as unchanged
+		// The frame still gets a statistics entry, marked as reused
+		// Returns false when a texture was invalidated since, Prepare has to be called instead
+		bool ReusePreparedFrame();
+
+		// Whether the last prepared frame draws something else than the one before it (geometry, commands, framebuffer size or an invalidated texture)
+		// When it doesn't, the commands recorded by the last Draw can be submitted again instead of recording them
+		inline bool HasFrameChanged() const { return m_frameChanged; }
+		// Makes the next prepared frame count as changed, for textures whose content was updated in place
+		inline void RequestRedraw() { m_redrawRequested = true; }
+
+		// Renders the prepared frame into an offscreen layer, only if it changed since the layer was last rendered
+		void RenderLayer(RenderResources& renderFrame);
+		// Blends the layer over the current render target
+		void DrawLayer(CommandBufferBuilder& builder);
+
+		// Pipelines are created by the first Prepare which has something to draw, this starts loading their shaders on a background thread
+		// The render device isn't thread-safe on every backend (OpenGL), so only shader modules are loaded there,
+		// shaders and pipelines are still instantiated by the first Prepare, which waits for the modules if they're not ready yet
+		void LoadPipelinesAsync();
+
+		// Statistics of the last frame (age 0) and of the ones before it, up to GetFrameStatsCount() - 1
+		// Every Prepare or successful ReusePreparedFrame call counts as a frame
+		const FrameStats& GetFrameStats(std::size_t age = 0) const;
+		inline std::size_t GetFrameStatsCount() const { return std::min<std::size_t>(m_frameIndex, FrameStatsHistorySize); }
+
+		// Number of pipeline, binding, vertex buffer and scissor changes elided from the last prepared frame
+		inline std::size_t GetSkippedStateChangeCount() const { return m_drawListCompiler.GetCommandStats().skippedStateChangeCount; }
+
+		// Draw lists are hashed and uploaded by worker threads when a frame holds at least this many bytes of geometry
+		inline std::size_t GetParallelPrepareThreshold() const { return m_drawListCompiler.GetParallelThreshold(); }
+		inline void SetParallelPrepareThreshold(std::size_t threshold) { m_drawListCompiler.SetParallelThreshold(threshold); }
+
+		// In single pipeline mode (the default), untextured commands sample a white texture instead of using their own pipeline,
+		// so interleaved textured and untextured commands don't switch pipelines
+		inline bool IsUsingSinglePipeline() const { return m_singlePipeline; }
+		void SetSinglePipeline(bool singlePipeline);
+
+		// Texture shader bindings are cached, least recently used ones are evicted past the budget
+		inline std::size_t GetTextureBindingBudget() const { return m_textureBindingBudget; }
+		inline const TextureBindingCacheStats& GetTextureBindingCacheStats() const { return m_textureBindingCacheStats; }
+		void SetTextureBindingBudget(std::size_t budget);
+
+		// Must be called before destroying a texture which was given to imgui, so a new texture reusing its address doesn't get a stale binding
+		void InvalidateTexture(const Texture* texture);
+
+		struct FrameStats
+		{
+			std::size_t drawListCount = 0;
+			std::size_t dirtyDrawListCount = 0;
+			std::size_t vertexCount = 0;
+			std::size_t indexCount = 0;
+			std::size_t drawCallCount = 0;
+			std::size_t pipelineChangeCount = 0;
+			std::size_t shaderBindingChangeCount = 0;
+			std::size_t skippedStateChangeCount = 0;
+			UInt64 uploadedBytes = 0;
+			std::chrono::nanoseconds prepareTime = std::chrono::nanoseconds::zero();
+			// zero when no command was recorded for the frame, as when the frame graph submits the ones recorded for an unchanged frame again
+			std::chrono::nanoseconds drawTime = std::chrono::nanoseconds::zero();
+			// the frame draws something else than the one before it
+			bool changed = true;
+			// ReusePreparedFrame kept the commands of the previous frame, the counts are theirs and nothing was read nor uploaded
+			bool reused = false;
+		};
+
+		struct TextureBindingCacheStats
+		{
+			std::size_t size = 0;
+			std::size_t hits = 0;
+			std::size_t misses = 0;
+			std::size_t evictions = 0;
+			std::size_t invalidations = 0;
+		};
+
+		static constexpr std::size_t DefaultTextureBindingBudget = 256;
+
+		// Number of frames whose statistics are kept
+		static constexpr std::size_t FrameStatsHistorySize = 120;
 	
+		// Number of vertex/index buffer sets kept alive, one per frame which may still be in flight on the GPU
+		static constexpr std::size_t FrameInFlightCount = 3;
+
 	private:
-		bool LoadTexturedPipeline();
-		bool LoadUntexturedPipeline();
+		struct GrowableBuffer;
+		struct Internals;
+
+		void CreateLayer(RenderResources& renderFrame, const Vector2i& size);
+		void DrawCommands(CommandBufferBuilder& builder, bool intoLayer);
+		void EnsurePipelinesLoaded();
+		bool EnsureBufferCapacity(RenderResources& renderFrame, GrowableBuffer& buffer, BufferType bufferType, UInt64 size);
+		const ShaderBinding* GetTextureShaderBinding(RenderResources& renderFrame, Texture* texture);
+		// Variant of a pipeline which accumulates alpha, commands are recorded with the regular ones
+		const RenderPipeline& GetLayerPipeline(const RenderPipeline& pipeline) const;
+		Texture* GetWhiteTexture(RenderResources& renderFrame, PixelFormat format);
+		void LoadCompositePipeline();
+		bool LoadTexturedPipeline(const nzsl::Ast::Module& shaderModule);
+		bool LoadUntexturedPipeline(const nzsl::Ast::Module& shaderModule);
+		void PrepareFrame(RenderResources& renderFrame, ImDrawData* drawData, ImTextureID fontTextureId, FrameStats& frameStats);
 
 		RenderDevice& m_renderDevice;
+		// texture binding cache and pipeline loading state
+		std::unique_ptr<Internals> m_internals;
+		std::shared_ptr<VertexDeclaration> m_vertexDeclaration;
 
-		struct DrawCall
-		{
-			size_t vertex_offset, indice_offset;
-			std::vector<ImDrawCmd> cmdBuffer;
-		};
-		std::vector<DrawCall> m_drawCalls;
+		ImguiDrawListCompiler m_drawListCompiler;
 
 		struct
 		{
 			std::shared_ptr<RenderPipeline> pipeline;
-			std::unordered_map<Texture*, ShaderBindingPtr> textureShaderBindings;
+			// used for a R8 font atlas (and the white texture matching it), sampled as white with their red channel as alpha
+			std::shared_ptr<RenderPipeline> alphaPipeline;
+			// used while rendering into the layer, which keeps coverage in its alpha channel
+			std::shared_ptr<RenderPipeline> layerPipeline;
+			std::shared_ptr<RenderPipeline> layerAlphaPipeline;
 			Nz::ShaderBindingPtr uboShaderBinding;
 			std::shared_ptr<TextureSampler> textureSampler;
 		} m_texturedPipeline;
@@ -55,11 +175,83 @@ namespace Nz
 		struct
 		{
 			std::shared_ptr<RenderPipeline> pipeline;
+			std::shared_ptr<RenderPipeline> layerPipeline;
 			Nz::ShaderBindingPtr uboShaderBinding;
 		} m_untexturedPipeline;
 
-		std::shared_ptr<RenderBuffer> m_vertexBuffer;
-		std::shared_ptr<RenderBuffer> m_indexBuffer;
+		struct TextureBinding
+		{
+			const Texture* texture;
+			ShaderBindingPtr binding;
+			Vector3ui textureSize;
+			PixelFormat textureFormat;
+			UInt64 lastUsedFrame;
+		};
+
+		std::vector<ShaderBindingPtr> m_invalidatedTextureBindings;
+		std::size_t m_textureBindingBudget;
+		TextureBindingCacheStats m_textureBindingCacheStats;
+		UInt64 m_frameIndex;
+
+		struct GrowableBuffer
+		{
+			std::shared_ptr<RenderBuffer> buffer;
+			UInt64 capacity = 0;
+			unsigned int underusedFrameCount = 0;
+		};
+
+		struct FrameBuffers
+		{
+			GrowableBuffer vertexBuffer;
+			GrowableBuffer indexBuffer;
+			ImguiDrawListCompiler::UploadCache uploadCache;
+			UInt64 lastUsedFrame = 0;
+		};
+		std::array<FrameBuffers, FrameInFlightCount> m_frameBuffers;
+		std::size_t m_currentFrameBuffers;
+		// buffer set referenced by the last recorded commands
+		std::size_t m_recordedFrameBuffers;
+
 		std::shared_ptr<RenderBuffer> m_uboBuffer;
+		Vector2i m_uboFramebufferSize;
+		// framebuffer size of the last prepared draw data
+		Vector2i m_framebufferSize;
+
+		// shader modules of the textured and untextured pipelines, deserialized without the render device
+		struct PipelineShaderModules
+		{
+			nzsl::Ast::ModulePtr textured;
+			nzsl::Ast::ModulePtr untextured;
+		};
+		static PipelineShaderModules LoadPipelineShaderModules();
+
+		bool m_pipelinesLoaded;
+
+		std::shared_ptr<Texture> m_whiteTexture;
+		bool m_singlePipeline;
+
+		UInt64 m_frameFingerprint;
+		UInt64 m_previousFrameFingerprint;
+		bool m_frameChanged;
+		bool m_redrawRequested;
+
+		struct
+		{
+			std::shared_ptr<RenderPipeline> pipeline;
+			std::shared_ptr<RenderBuffer> quadVertexBuffer;
+		} m_compositePipeline;
+
+		struct
+		{
+			std::shared_ptr<Texture> texture;
+			std::shared_ptr<RenderPass> renderPass;
+			std::shared_ptr<Framebuffer> framebuffer;
+			ShaderBindingPtr binding;
+			ImguiLayerState state;
+			Vector2i size;
+		} m_layer;
+
+		// ring buffer indexed by frame index
+		std::array<FrameStats, FrameStatsHistorySize> m_frameStats;
 	};
 }
\ No newline at end of file
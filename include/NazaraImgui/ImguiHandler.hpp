@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+
 /*
     ImguiHandler.hpp
     Inherit from this base class for your Imgui code to be called by the Imgui renderer
@@ -11,5 +13,12 @@ namespace Nz
     {
     public:
         virtual void OnRenderImgui() = 0;
+
+        // Name shown in the handler timings
+        virtual const char* GetImguiHandlerName() const { return "ImguiHandler"; }
+
+        // Minimal time between two OnRenderImgui calls, in between the windows the handler began are drawn again from what it last generated,
+        // unless they're hovered, focused, moved or resized. Zero (the default) rebuilds them every frame
+        virtual std::chrono::nanoseconds GetImguiRefreshInterval() const { return std::chrono::nanoseconds::zero(); }
     };
 }
\ No newline at end of file
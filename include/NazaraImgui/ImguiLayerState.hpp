@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Nazara/Math/Vector2.hpp>
+
+/*
+    ImguiLayerState.hpp
+    Decides what ImguiDrawer::RenderLayer does with its offscreen layer: create it, render the prepared frame into it,
+    or keep what it holds when the frame didn't change. It doesn't depend on a render device.
+*/
+
+namespace Nz
+{
+	class ImguiLayerState
+	{
+	public:
+		enum class Update
+		{
+			None,    //< nothing was prepared, the layer isn't composited
+			Create,  //< the layer has to be (re)created at the framebuffer size, then rendered
+			Render,  //< the layer is rendered again
+			Reuse    //< the layer already holds the prepared frame
+		};
+
+		ImguiLayerState() = default;
+
+		// Whether DrawLayer has something to composite
+		inline bool IsUpToDate() const { return m_upToDate; }
+
+		// Called once per RenderLayer with the size and change state of the prepared frame, the layer counts as up to date afterwards
+		// (unless nothing was prepared)
+		inline Update Prepare(const Vector2i& framebufferSize, bool frameChanged)
+		{
+			if (framebufferSize.x <= 0 || framebufferSize.y <= 0)
+			{
+				// don't composite what the layer held before
+				m_upToDate = false;
+				return Update::None;
+			}
+
+			Update update;
+			if (!m_created || m_size != framebufferSize)
+				update = Update::Create;
+			else if (m_upToDate && !frameChanged)
+				return Update::Reuse;
+			else
+				update = Update::Render;
+
+			m_created = true;
+			m_size = framebufferSize;
+			m_upToDate = true;
+
+			return update;
+		}
+
+	private:
+		Vector2i m_size = Vector2i::Zero();
+		bool m_created = false;
+		bool m_upToDate = false;
+	};
+}
@@ -9,6 +9,8 @@ namespace Nz
 {
 	class PassData;
 
+	// With the "CachedLayer" boolean parameter, the UI is rendered into an offscreen layer which is only redrawn when it changes,
+	// and composited over the output every frame
 	class NAZARA_IMGUI_API ImguiPipelinePass
 		: public FramePipelinePass
 	{
@@ -23,5 +25,6 @@ namespace Nz
 
 	private:
 		std::string m_passName;
+		bool m_cachedLayer;
 	};
 }
\ No newline at end of file
@@ -27,4 +27,10 @@ namespace ImGui
     NAZARA_IMGUI_API void DrawLine(const Nz::Vector2f& a, const Nz::Vector2f& b, const Nz::Color& col, float thickness = 1.0f);
     NAZARA_IMGUI_API void DrawRect(const Nz::Rectf& rect, const Nz::Color& color, float rounding = 0.0f, int rounding_corners = 0x0F, float thickness = 1.0f);
     NAZARA_IMGUI_API void DrawRectFilled(const Nz::Rectf& rect, const Nz::Color& color, float rounding = 0.0f, int rounding_corners = 0x0F);
+
+    // Window showing the statistics of the frames drawn by the Imgui module
+    NAZARA_IMGUI_API void NazaraRendererStats(bool* open = nullptr);
+
+    // Window showing how long each handler takes to build its UI, handlers over their budget are highlighted
+    NAZARA_IMGUI_API void NazaraHandlerTimings(bool* open = nullptr);
 }
\ No newline at end of file
@@ -3,14 +3,24 @@
 #include <Nazara/Core/ModuleBase.hpp>
 #include <Nazara/Graphics/Graphics.hpp>
 #include <NazaraImgui/Config.hpp>
+#include <NazaraImgui/ImguiDrawDataSnapshot.hpp>
 #include <NazaraImgui/ImguiDrawer.hpp>
 
 #include <imgui.h>
-#include <unordered_set>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace Nz
 {
     class Cursor;
+    class ImguiGlyphAtlas;
     class RenderTarget;
     class RenderWindow;
     class Swapchain;
@@ -27,6 +37,7 @@ namespace Nz
     public:
         using Dependencies = TypeList<Graphics>;
         struct Config;
+        struct HandlerTiming;
 
         Imgui(Config config);
         ~Imgui();
@@ -36,13 +47,46 @@ namespace Nz
         void Render();
         void Render(Nz::Swapchain* renderTarget, Nz::RenderResources& frame);
 
+        // Prepares the drawer with the last rendered frame, which is its snapshot when draw data snapshots are enabled
+        // Render() may then run on another thread than this, the next frame is built while this one is drawn
+        void PrepareDrawer(Nz::RenderResources& frame);
+
+        // Builds the font atlas and uploads it, call it outside of a frame after adding or changing fonts
+        // The texture is kept when the atlas size doesn't change, only the rows which differ are uploaded again
+        void UpdateFontTexture();
+        // Makes the glyphs of this text available in the font (the default one if null) from the next frame on
+        // They are rasterized into the free space of the atlas, it's only built again once that space is full
+        // Must be called from the thread running Update, which adds them before starting the frame
+        void EnsureGlyphs(std::string_view text, ImFont* font = nullptr);
+
         inline ImguiDrawer& GetImguiDrawer() { return m_imguiDrawer; }
         inline const ImguiDrawer& GetImguiDrawer() const { return m_imguiDrawer; }
 
-        // User-defined
-        void AddHandler(ImguiHandler* handler);
+        // User-defined, handlers run by increasing priority then in the order they were added
+        // Adding a handler again only changes its priority
+        // Handlers may add or remove handlers from OnRenderImgui, this is applied once all of them ran
+        // (a removed handler isn't called anymore, even if its turn didn't come yet this frame)
+        void AddHandler(ImguiHandler* handler, int priority = 0);
         void RemoveHandler(ImguiHandler* handler);
 
+        // In idle mode, makes the next Update run an imgui frame
+        // Can be called from any thread, and from a handler to have the frame after the current one run
+        void RequestRedraw();
+        // In idle mode, keeps imgui frames running for this long, for animated content
+        void RequestAnimation(std::chrono::nanoseconds duration);
+        // Whether the last Update skipped the imgui frame, the last one is drawn again then
+        inline bool IsIdle() const { return m_bFrameSkipped; }
+
+        // How long the last input event given to imgui waited in the queue since the window reported it
+        inline std::chrono::nanoseconds GetLastInputLatency() const { return m_lastInputLatency; }
+
+        // Handlers in the order they run, with how long their OnRenderImgui took
+        inline const std::vector<HandlerTiming>& GetHandlerTimings() const { return m_handlers; }
+        // A warning is emitted when a handler starts exceeding its budget, zero disables it
+        void SetHandlerBudget(ImguiHandler* handler, std::chrono::nanoseconds budget);
+        // Makes a handler with a refresh interval run on next Render instead of having its windows replayed
+        void RefreshHandler(ImguiHandler* handler);
+
         // Clipboard functions
         static void SetClipboardText(void* userData, const char* text);
         static const char* GetClipboardText(void* userData);
@@ -50,33 +94,147 @@ namespace Nz
         struct Config
         {
             Nz::Vector2f framebufferSize;
+            // upload the font atlas as a R8 texture (a quarter of the memory of RGBA8), glyphs can't be colored then
+            bool singleChannelFontAtlas = false;
+            // when set, the built font atlas is saved to this file and loaded back instead of being rasterized on next start
+            std::filesystem::path fontAtlasCachePath;
+            // room kept in the font atlas for glyphs added by EnsureGlyphs, on top of what's left below the packed glyphs
+            Nz::Vector2ui fontAtlasGlyphReserve = Nz::Vector2ui(256, 128);
+            // deserialize the shader modules of the render pipelines on a background thread when the module is created
+            // that's the only part done there (the OpenGL device can't be used from another thread): instantiating the shaders
+            // and creating the pipelines still blocks the first Prepare which draws something, so this doesn't remove that stall
+            bool loadPipelinesInBackground = false;
+            // Render() captures the draw data into a snapshot the drawer is prepared from, so building the next frame doesn't wait for rendering
+            bool snapshotDrawData = false;
+            // only run imgui frames after input, a redraw request or when the keep-alive deadline passes, the last frame is drawn again otherwise
+            // Update doesn't call ImGui::NewFrame for a skipped frame: imgui functions called outside of handlers must check IsIdle() first
+            bool idleMode = false;
+            // frames keep running this long after an input, so hover effects and imgui's own animations settle
+            std::chrono::milliseconds idleSettleTime = std::chrono::milliseconds(500);
+            // an idle UI still runs a frame this often, for values which change without input
+            std::chrono::milliseconds idleKeepAlive = std::chrono::milliseconds(1000);
+        };
+
+        struct HandlerTiming
+        {
+            ImguiHandler* handler;
+            int priority;
+            std::chrono::nanoseconds budget = std::chrono::nanoseconds::zero();
+            std::chrono::nanoseconds lastTime = std::chrono::nanoseconds::zero();
+            // exponential moving average, smooths out single slow frames
+            std::chrono::nanoseconds averageTime = std::chrono::nanoseconds::zero();
+            std::chrono::nanoseconds maxTime = std::chrono::nanoseconds::zero();
+            std::size_t callCount = 0;
+            // frames where the handler wasn't run and its windows were drawn from its last call
+            std::size_t replayCount = 0;
+            std::size_t overBudgetCount = 0;
+            bool overBudget = false;
         };
 
         static ImGuiContext* GetCurrentContext();
         static void GetAllocatorFunctions(ImGuiMemAllocFunc* allocFunc, ImGuiMemFreeFunc* freeFunc, void** userData);
 
     private:
+        struct ThrottledHandler;
+
+        // Window input, queued by the event handlers and given to imgui by Update
+        struct InputEvent
+        {
+            enum class Type
+            {
+                Focus,
+                Key,
+                MouseButton,
+                MousePos,
+                MouseWheel,
+                Text
+            };
+
+            InputEvent(Type eventType) : type(eventType) {}
+
+            Type type;
+            std::chrono::steady_clock::time_point timestamp;
+            ImVec2 position = ImVec2(0.f, 0.f); //< mouse position or wheel delta
+            int code = 0; //< scancode, imgui mouse button or character
+            bool down = false; //< key or button pressed, focus gained
+        };
+
+        // Handlers added or removed while Render runs them
+        struct PendingHandlerChange
+        {
+            ImguiHandler* handler;
+            int priority;
+            bool remove;
+        };
+
         void RenderInternal();
+        bool ShouldRunFrame(std::chrono::steady_clock::time_point now);
+        void WakeUp();
+        void KeepActiveUntil(std::chrono::steady_clock::time_point until);
+        void RecordHandlerTime(HandlerTiming& timing, std::chrono::nanoseconds time);
+        void InsertHandler(ImguiHandler* handler, int priority);
+        void EraseHandler(ImguiHandler* handler);
+        bool IsHandlerRemovalPending(const ImguiHandler* handler) const;
+        void ApplyPendingHandlerChanges();
 
         void SetupInputs(Nz::WindowEventHandler& handler);
-        void Update(const Nz::Vector2i& mousePosition, const Nz::Vector2ui& displaySize, float dt);
+        // Events which need focus are dropped while the window doesn't have it
+        void PushInputEvent(InputEvent& inputEvent, bool requiresFocus = true);
+        // Returns whether the window had focus when the events were handed over
+        bool ProcessInputEvents();
+        void Update(const Nz::Vector2ui& displaySize, float dt);
+        void ProcessPendingGlyphs();
 
         // Cursor functions
         std::shared_ptr<Nz::Cursor> GetMouseCursor(ImGuiMouseCursor cursorType);
         void UpdateMouseCursor(Nz::Window& window);
 
-        void UpdateFontTexture();
-
         ImGuiContext* m_currentContext;
         std::string m_clipboardText;
         Nz::Window* m_window;
 
+        // event handlers may run on another thread than the UI, what they write is guarded by m_inputMutex
+        // (m_bWindowHasFocus, m_inputEvents and m_activeUntil)
         bool m_bWindowHasFocus;
-        bool m_bMouseMoved;
+        std::vector<InputEvent> m_inputEvents;
+        std::vector<InputEvent> m_processedInputEvents;
+        std::mutex m_inputMutex;
+        ImGuiKeyModFlags m_keyModifiers;
+        std::chrono::nanoseconds m_lastInputLatency;
+
+        bool m_bIdleMode;
+        bool m_bFrameSkipped;
+        std::atomic_bool m_bRedrawRequested;
+        float m_skippedDeltaTime;
+        std::chrono::milliseconds m_idleSettleTime;
+        std::chrono::milliseconds m_idleKeepAlive;
+        std::chrono::steady_clock::time_point m_activeUntil;
+        std::chrono::steady_clock::time_point m_lastFrameTime;
+        bool m_bSingleChannelFontAtlas;
+        std::filesystem::path m_fontAtlasCachePath;
+        Nz::Vector2ui m_fontAtlasGlyphReserve;
 
         ImguiDrawer m_imguiDrawer;
         std::shared_ptr<Nz::Texture> m_fontTexture;
-        std::unordered_set<ImguiHandler*> m_handlers;
+        // fingerprint of each band of rows of the last uploaded font atlas, to find which ones changed without keeping a copy of it
+        std::vector<Nz::UInt64> m_fontAtlasBandFingerprints;
+        std::unique_ptr<ImguiGlyphAtlas> m_glyphAtlas;
+        std::unordered_map<ImFont*, std::vector<ImWchar>> m_pendingGlyphs;
+        // replaced font textures, frames in flight may still sample them (guarded by m_snapshotMutex)
+        std::vector<std::shared_ptr<Nz::Texture>> m_releasedFontTextures;
+        std::vector<HandlerTiming> m_handlers;
+        std::vector<PendingHandlerChange> m_pendingHandlerChanges;
+        std::unordered_map<const ImguiHandler*, std::unique_ptr<ThrottledHandler>> m_throttledHandlers;
+        // m_handlers is being iterated, handler changes are queued meanwhile
+        bool m_bRunningHandlers;
+
+        // the back snapshot is only touched by Render(), the front one only while holding the mutex
+        bool m_bSnapshotDrawData;
+        std::array<ImguiDrawDataSnapshot, 2> m_drawDataSnapshots;
+        std::size_t m_frontSnapshot;
+        // whether Render produced draw data the drawer wasn't prepared with yet
+        bool m_bDrawDataPending;
+        std::mutex m_snapshotMutex;
 
         static Imgui* s_instance;
 
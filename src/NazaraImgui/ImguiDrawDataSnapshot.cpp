@@ -0,0 +1,38 @@
+#include <NazaraImgui/ImguiDrawDataSnapshot.hpp>
+
+namespace Nz
+{
+	void ImguiDrawDataSnapshot::Capture(ImDrawData& drawData)
+	{
+		// the drawer picks the pipeline of the font atlas from it
+		m_fontTextureId = ImGui::GetIO().Fonts->TexID;
+
+		if (!drawData.Valid)
+		{
+			m_drawData.Clear();
+			return;
+		}
+
+		std::size_t drawListCount = std::size_t(drawData.CmdListsCount);
+		while (m_drawLists.size() < drawListCount)
+			m_drawLists.push_back(std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData()));
+
+		m_drawListPointers.resize(drawListCount);
+		for (std::size_t n = 0; n < drawListCount; ++n)
+		{
+			ImDrawList* source = drawData.CmdLists[n];
+			ImDrawList* drawList = m_drawLists[n].get();
+
+			// imgui resets its draw lists before reusing them, the buffers it gets back keep their capacity
+			drawList->CmdBuffer.swap(source->CmdBuffer);
+			drawList->IdxBuffer.swap(source->IdxBuffer);
+			drawList->VtxBuffer.swap(source->VtxBuffer);
+			drawList->Flags = source->Flags;
+
+			m_drawListPointers[n] = drawList;
+		}
+
+		m_drawData = drawData;
+		m_drawData.CmdLists = m_drawListPointers.data();
+	}
+}
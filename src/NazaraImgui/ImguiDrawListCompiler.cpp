@@ -0,0 +1,264 @@
+#include <NazaraImgui/ImguiDrawListCompiler.hpp>
+
+#include <NazaraImgui/ImguiFingerprint.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+namespace Nz
+{
+	ImguiDrawListCompiler::ImguiDrawListCompiler()
+		: m_activeTaskScheduler(nullptr)
+		, m_frameFingerprint(0)
+		, m_dirtyGeometrySize(0)
+		, m_geometrySize(0)
+		, m_parallelThreshold(DefaultParallelThreshold)
+	{
+	}
+
+	ImguiDrawListCompiler::~ImguiDrawListCompiler() = default;
+
+	// Splits draw lists in ranges of roughly equal geometry size, one per worker, and waits for them to be processed
+	template<typename F>
+	void ImguiDrawListCompiler::DispatchDrawListRanges(F&& func)
+	{
+		std::size_t count = m_preparedDrawLists.size();
+		if (!m_activeTaskScheduler || count == 0)
+		{
+			func(std::size_t(0), count);
+			return;
+		}
+
+		std::size_t taskCount = std::clamp<std::size_t>(m_activeTaskScheduler->GetWorkerCount(), 1, count);
+		std::size_t sizePerTask = m_geometrySize / taskCount + 1;
+
+		// ranges are built before any task is queued so they don't move while tasks run
+		m_taskRanges.clear();
+
+		std::size_t first = 0;
+		std::size_t size = 0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			size += m_preparedDrawLists[i].geometrySize;
+			if (size >= sizePerTask || i + 1 == count)
+			{
+				m_taskRanges.push_back({ first, i + 1 });
+
+				first = i + 1;
+				size = 0;
+			}
+		}
+
+		// tasks only capture two pointers, which fits in std::function small buffer and avoids a heap allocation per task
+		for (const TaskRange& range : m_taskRanges)
+		{
+			m_activeTaskScheduler->AddTask([&func, &range]
+			{
+				func(range.first, range.last);
+			});
+		}
+
+		m_activeTaskScheduler->WaitForTasks();
+	}
+
+	std::size_t ImguiDrawListCompiler::PrepareDrawLists(const ImDrawData& drawData, UploadCache& uploadCache)
+	{
+		// draw list offsets are a prefix sum, after which each list can be processed independently
+		m_preparedDrawLists.resize(drawData.CmdListsCount);
+		uploadCache.resize(drawData.CmdListsCount);
+
+		std::size_t vertexOffset = 0;
+		std::size_t indexOffset = 0;
+		for (int n = 0; n < drawData.CmdListsCount; ++n)
+		{
+			const ImDrawList* cmd_list = drawData.CmdLists[n];
+
+			PreparedDrawList& preparedDrawList = m_preparedDrawLists[n];
+			preparedDrawList.drawList = cmd_list;
+			preparedDrawList.vertexOffset = vertexOffset;
+			preparedDrawList.indexOffset = indexOffset;
+			preparedDrawList.geometrySize = cmd_list->VtxBuffer.size() * sizeof(ImDrawVert) + cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx);
+
+			vertexOffset += cmd_list->VtxBuffer.size();
+			indexOffset += cmd_list->IdxBuffer.size();
+		}
+
+		m_geometrySize = vertexOffset * sizeof(ImDrawVert) + indexOffset * sizeof(ImDrawIdx);
+
+		m_activeTaskScheduler = nullptr;
+		if (drawData.CmdListsCount > 1 && m_geometrySize >= m_parallelThreshold)
+		{
+			if (!m_taskScheduler)
+				m_taskScheduler = std::make_unique<TaskScheduler>();
+
+			m_activeTaskScheduler = m_taskScheduler.get();
+		}
+
+		// only upload draw lists whose content or place in the buffers changed since this buffer set was last used
+		std::atomic_size_t dirtyDrawListCount = 0;
+		std::atomic_size_t dirtyGeometrySize = 0;
+		DispatchDrawListRanges([&](std::size_t first, std::size_t last)
+		{
+			std::size_t dirtyCount = 0;
+			std::size_t dirtySize = 0;
+			for (std::size_t n = first; n < last; ++n)
+			{
+				PreparedDrawList& preparedDrawList = m_preparedDrawLists[n];
+				const ImDrawList* cmd_list = preparedDrawList.drawList;
+
+				UInt64 fingerprint = ImguiFingerprint::Compute(cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.size() * sizeof(ImDrawVert));
+				fingerprint = ImguiFingerprint::Compute(cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx), fingerprint);
+
+				// ImDrawCmd is zeroed on construction, padding included, so it can be hashed as raw memory
+				preparedDrawList.commandFingerprint = ImguiFingerprint::Compute(cmd_list->CmdBuffer.Data, cmd_list->CmdBuffer.size() * sizeof(ImDrawCmd), fingerprint);
+
+				const UploadedDrawList& uploadedDrawList = uploadCache[n];
+				preparedDrawList.fingerprint = fingerprint;
+				preparedDrawList.dirty = !uploadedDrawList.valid || uploadedDrawList.fingerprint != fingerprint ||
+				                         uploadedDrawList.vertexOffset != preparedDrawList.vertexOffset || uploadedDrawList.vertexCount != std::size_t(cmd_list->VtxBuffer.size()) ||
+				                         uploadedDrawList.indexOffset != preparedDrawList.indexOffset || uploadedDrawList.indexCount != std::size_t(cmd_list->IdxBuffer.size());
+
+				if (preparedDrawList.dirty)
+				{
+					dirtyCount++;
+					dirtySize += preparedDrawList.geometrySize;
+				}
+			}
+
+			dirtyDrawListCount += dirtyCount;
+			dirtyGeometrySize += dirtySize;
+		});
+
+		m_dirtyGeometrySize = dirtyGeometrySize;
+
+		m_frameFingerprint = ImguiFingerprint::Compute(&m_geometrySize, sizeof(m_geometrySize));
+		for (const PreparedDrawList& preparedDrawList : m_preparedDrawLists)
+			m_frameFingerprint = ImguiFingerprint::Compute(&preparedDrawList.commandFingerprint, sizeof(preparedDrawList.commandFingerprint), m_frameFingerprint);
+
+		return dirtyDrawListCount;
+	}
+
+	void ImguiDrawListCompiler::UploadDrawLists(void* vertices, void* indices, UploadCache& uploadCache)
+	{
+		UInt8* vertexBytes = static_cast<UInt8*>(vertices);
+		UInt8* indexBytes = static_cast<UInt8*>(indices);
+
+		DispatchDrawListRanges([&](std::size_t first, std::size_t last)
+		{
+			for (std::size_t n = first; n < last; ++n)
+			{
+				const PreparedDrawList& preparedDrawList = m_preparedDrawLists[n];
+				if (!preparedDrawList.dirty)
+					continue;
+
+				const ImDrawList* cmd_list = preparedDrawList.drawList;
+				if (!cmd_list->VtxBuffer.empty())
+					std::memcpy(vertexBytes + preparedDrawList.vertexOffset * sizeof(ImDrawVert), cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.size() * sizeof(ImDrawVert));
+
+				if (!cmd_list->IdxBuffer.empty())
+					std::memcpy(indexBytes + preparedDrawList.indexOffset * sizeof(ImDrawIdx), cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx));
+
+				UploadedDrawList& uploadedDrawList = uploadCache[n];
+				uploadedDrawList.valid = true;
+				uploadedDrawList.fingerprint = preparedDrawList.fingerprint;
+				uploadedDrawList.vertexOffset = preparedDrawList.vertexOffset;
+				uploadedDrawList.vertexCount = cmd_list->VtxBuffer.size();
+				uploadedDrawList.indexOffset = preparedDrawList.indexOffset;
+				uploadedDrawList.indexCount = cmd_list->IdxBuffer.size();
+			}
+		});
+	}
+
+	void ImguiDrawListCompiler::CompileCommands(DrawStateResolver resolveDrawState, const ImVec2& clipScale)
+	{
+		// storage is kept across frames, clearing doesn't release it
+		m_drawCommands.clear();
+		m_commandStats = CommandStats{};
+
+		// this is the state the command stream leaves the command buffer in, commands only carry what differs from it
+		const RenderPipeline* currentPipeline = nullptr;
+		const ShaderBinding* currentTextureBinding = nullptr;
+		Recti currentScissor(0, 0, -1, -1);
+		UInt64 currentVertexBufferOffset = std::numeric_limits<UInt64>::max();
+
+		for (const PreparedDrawList& preparedDrawList : m_preparedDrawLists)
+		{
+			for (const ImDrawCmd& cmd : preparedDrawList.drawList->CmdBuffer)
+			{
+				if (cmd.UserCallback || cmd.ElemCount == 0)
+					continue;
+
+				// scaled here rather than in the draw data, which may be prepared more than once
+				ImVec4 rect(cmd.ClipRect.x * clipScale.x, cmd.ClipRect.y * clipScale.y, cmd.ClipRect.z * clipScale.x, cmd.ClipRect.w * clipScale.y);
+				if (rect.z <= rect.x || rect.w <= rect.y)
+					continue;
+
+				DrawCommand& drawCommand = m_drawCommands.emplace_back();
+				drawCommand.stateChanges = 0;
+				drawCommand.firstIndex = UInt32(preparedDrawList.indexOffset + cmd.IdxOffset);
+				drawCommand.indexCount = cmd.ElemCount;
+
+				// DrawIndexed has no vertex offset parameter, base vertex is applied by binding the vertex buffer at an offset
+				drawCommand.vertexBufferOffset = (preparedDrawList.vertexOffset + cmd.VtxOffset) * sizeof(ImDrawVert);
+				if (drawCommand.vertexBufferOffset != currentVertexBufferOffset)
+				{
+					drawCommand.stateChanges |= DrawCommand::VertexBufferChange;
+					currentVertexBufferOffset = drawCommand.vertexBufferOffset;
+					m_commandStats.vertexBufferChangeCount++;
+				}
+				else
+					m_commandStats.skippedStateChangeCount++;
+
+				DrawState drawState = resolveDrawState(cmd.GetTexID());
+				drawCommand.pipeline = drawState.pipeline;
+				drawCommand.uboBinding = drawState.uboBinding;
+				drawCommand.textureBinding = drawState.textureBinding;
+
+				if (drawCommand.pipeline != currentPipeline)
+				{
+					// pipelines don't share the same layout, bindings have to be set again after a switch
+					drawCommand.stateChanges |= DrawCommand::PipelineChange;
+					currentPipeline = drawCommand.pipeline;
+					currentTextureBinding = nullptr;
+					m_commandStats.pipelineChangeCount++;
+					m_commandStats.shaderBindingChangeCount++;
+				}
+				else
+					m_commandStats.skippedStateChangeCount++;
+
+				if (drawCommand.textureBinding && drawCommand.textureBinding != currentTextureBinding)
+				{
+					drawCommand.stateChanges |= DrawCommand::TextureBindingChange;
+					currentTextureBinding = drawCommand.textureBinding;
+					m_commandStats.shaderBindingChangeCount++;
+				}
+				else if (drawCommand.textureBinding)
+					m_commandStats.skippedStateChangeCount++;
+
+				drawCommand.scissor = Recti{ int(rect.x), int(rect.y), int(rect.z - rect.x), int(rect.w - rect.y) };
+				if (drawCommand.scissor != currentScissor)
+				{
+					drawCommand.stateChanges |= DrawCommand::ScissorChange;
+					currentScissor = drawCommand.scissor;
+					m_commandStats.scissorChangeCount++;
+				}
+				else
+					m_commandStats.skippedStateChangeCount++;
+			}
+		}
+
+		m_commandStats.drawCallCount = m_drawCommands.size();
+	}
+
+	void ImguiDrawListCompiler::Clear()
+	{
+		m_preparedDrawLists.clear();
+		m_drawCommands.clear();
+		m_commandStats = CommandStats{};
+		m_frameFingerprint = 0;
+		m_dirtyGeometrySize = 0;
+		m_geometrySize = 0;
+	}
+}
@@ -1,45 +1,69 @@
 #include <NazaraImgui/ImguiDrawer.hpp>
 
+#include <NazaraImgui/ImguiFingerprint.hpp>
 #include <NazaraImgui/NazaraImgui.hpp>
 
-#include <Nazara/Core/VertexStruct.hpp>
+#include <Nazara/Core/VertexDeclaration.hpp>
 #include <Nazara/Renderer/CommandBufferBuilder.hpp>
+#include <Nazara/Renderer/Framebuffer.hpp>
 #include <Nazara/Renderer/RenderDevice.hpp>
 #include <Nazara/Renderer/RenderFrame.hpp>
+#include <Nazara/Renderer/RenderPass.hpp>
+#include <Nazara/Renderer/Texture.hpp>
 #include <Nazara/Renderer/UploadPool.hpp>
 
 
-#include <NZSL/Parser.hpp>
+#include <NZSL/Serializer.hpp>
+#include <NZSL/Ast/AstSerializer.hpp>
+#include <NZSL/Ast/Option.hpp>
 
-const char shaderSource_Textured[] =
-#include "Textured.nzsl.h"
-;
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <future>
+#include <list>
+#include <unordered_map>
 
-const char shaderSource_Untextured[] =
-#include "Untextured.nzsl.h"
-;
+// shaders are compiled and optimized by the build (see xmake/rules/compile_shaders.lua), only deserialized at runtime
+const Nz::UInt8 shaderBinary_Textured[] = {
+#include "Textured.nzslb.h"
+};
 
-namespace
-{
-    inline Nz::Vector2f ToNzVec2(ImVec2 v)
-    {
-        return { v.x, v.y };
-    }
+const Nz::UInt8 shaderBinary_Untextured[] = {
+#include "Untextured.nzslb.h"
+};
 
-    inline Nz::Vector3f ToNzVec3(ImVec2 v)
-    {
-        return { v.x, v.y, 0.f };
-    }
+const Nz::UInt8 shaderBinary_Composite[] = {
+#include "Composite.nzslb.h"
+};
 
-    inline Nz::Color ToNzColor(ImU32 color)
-    {
-        auto c = ImGui::ColorConvertU32ToFloat4(color);
-        return { c.x, c.y, c.z, c.w };
-    }
+// vertices are uploaded as-is, the vertex declaration has to match ImDrawVert memory layout
+static_assert(sizeof(ImDrawVert) == 20, "ImDrawVert layout is not supported");
+static_assert(offsetof(ImDrawVert, pos) == 0, "ImDrawVert layout is not supported");
+static_assert(offsetof(ImDrawVert, uv) == 8, "ImDrawVert layout is not supported");
+static_assert(offsetof(ImDrawVert, col) == 16, "ImDrawVert layout is not supported");
+
+static_assert(sizeof(ImDrawIdx) == 2 || sizeof(ImDrawIdx) == 4, "ImDrawIdx must be 16 or 32 bits");
+
+namespace
+{
+    // indices are uploaded as-is too, vertex offsets are applied when binding the vertex buffer
+    constexpr Nz::IndexType ImguiIndexType = (sizeof(ImDrawIdx) == sizeof(Nz::UInt16)) ? Nz::IndexType::U16 : Nz::IndexType::U32;
 }
 
 namespace Nz
 {
+	// kept out of the header, its users don't need <future> and <list>
+	struct ImguiDrawer::Internals
+	{
+		// most recently used bindings first
+		std::list<TextureBinding> textureBindings;
+		std::unordered_map<const Texture*, std::list<TextureBinding>::iterator> textureBindingByTexture;
+
+		std::future<PipelineShaderModules> pipelineLoading;
+	};
+
 	struct ImguiUbo
 	{
 		float screenWidth;
@@ -48,169 +72,704 @@ namespace Nz
 
 	ImguiDrawer::ImguiDrawer(RenderDevice& renderDevice)
         : m_renderDevice(renderDevice)
+        , m_internals(std::make_unique<Internals>())
+        , m_currentFrameBuffers(0)
+        , m_recordedFrameBuffers(0)
+        , m_textureBindingBudget(DefaultTextureBindingBudget)
+        , m_frameIndex(0)
+        , m_uboFramebufferSize(0, 0)
+        , m_framebufferSize(0, 0)
+        , m_pipelinesLoaded(false)
+        , m_singlePipeline(true)
+        , m_frameFingerprint(0)
+        , m_previousFrameFingerprint(0)
+        , m_frameChanged(true)
+        , m_redrawRequested(true)
 	{
-        LoadTexturedPipeline();
-        LoadUntexturedPipeline();
+        m_vertexDeclaration = std::make_shared<VertexDeclaration>(VertexInputRate::Vertex, std::initializer_list<VertexDeclaration::ComponentEntry>{
+            { VertexComponent::Position, ComponentType::Float2, 0 },
+            { VertexComponent::TexCoord, ComponentType::Float2, 0 },
+            { VertexComponent::Color,    ComponentType::Color,  0 }
+        });
+
+        // pipelines are created when first needed, see EnsurePipelinesLoaded
 	}
 
+	ImguiDrawer::ImguiDrawer(ImguiDrawer&&) noexcept = default;
+
 	ImguiDrawer::~ImguiDrawer()
 	{
+		for (FrameBuffers& frameBuffers : m_frameBuffers)
+		{
+			frameBuffers.vertexBuffer.buffer.reset();
+			frameBuffers.indexBuffer.buffer.reset();
+		}
+
+		m_layer.binding.reset();
+		m_layer.framebuffer.reset();
+		m_layer.renderPass.reset();
+		m_layer.texture.reset();
+		m_compositePipeline.quadVertexBuffer.reset();
+		m_compositePipeline.pipeline.reset();
+
+		m_whiteTexture.reset();
+
 		m_untexturedPipeline.uboShaderBinding.reset();
+		m_untexturedPipeline.layerPipeline.reset();
 		m_untexturedPipeline.pipeline.reset();
 
 		m_texturedPipeline.uboShaderBinding.reset();
-		m_texturedPipeline.textureShaderBindings.clear();
+		// a moved-from drawer has no internals
+		if (m_internals)
+		{
+			m_internals->textureBindingByTexture.clear();
+			m_internals->textureBindings.clear();
+		}
+		m_invalidatedTextureBindings.clear();
 		m_texturedPipeline.textureSampler.reset();
+		m_texturedPipeline.layerAlphaPipeline.reset();
+		m_texturedPipeline.layerPipeline.reset();
+		m_texturedPipeline.alphaPipeline.reset();
 		m_texturedPipeline.pipeline.reset();
 	}
 
 	void ImguiDrawer::Prepare(RenderResources& frame)
 	{
-        m_drawCalls.clear();
+        Prepare(frame, ImGui::GetDrawData(), ImGui::GetIO().Fonts->TexID);
+	}
+
+	void ImguiDrawer::Prepare(RenderResources& frame, ImDrawData* drawData, ImTextureID fontTextureId)
+	{
+        auto start = std::chrono::steady_clock::now();
+
+        m_drawListCompiler.Clear();
+        m_frameIndex++;
+
+        FrameStats& frameStats = m_frameStats[m_frameIndex % FrameStatsHistorySize];
+        frameStats = FrameStats{};
+
+        m_frameFingerprint = 0;
+        PrepareFrame(frame, drawData, fontTextureId, frameStats);
+
+        m_frameChanged = m_redrawRequested || m_frameFingerprint != m_previousFrameFingerprint;
+        m_previousFrameFingerprint = m_frameFingerprint;
+        m_redrawRequested = false;
+
+        frameStats.changed = m_frameChanged;
+        frameStats.prepareTime = std::chrono::steady_clock::now() - start;
+	}
 
-        ImDrawData* drawData = ImGui::GetDrawData();
-        if (drawData == nullptr || drawData->CmdListsCount == 0)
+    bool ImguiDrawer::ReusePreparedFrame()
+    {
+        // the prepared commands may reference bindings of invalidated textures
+        if (m_redrawRequested)
+            return false;
+
+        m_frameChanged = false;
+
+        // the frame draws the same commands, which have the same counts
+        const FrameStats& preparedStats = m_frameStats[m_frameIndex % FrameStatsHistorySize];
+        m_frameIndex++;
+
+        FrameStats& frameStats = m_frameStats[m_frameIndex % FrameStatsHistorySize];
+        frameStats = preparedStats;
+        frameStats.dirtyDrawListCount = 0;
+        frameStats.uploadedBytes = 0;
+        frameStats.prepareTime = std::chrono::nanoseconds::zero();
+        frameStats.drawTime = std::chrono::nanoseconds::zero();
+        frameStats.changed = false;
+        frameStats.reused = true;
+
+        return true;
+    }
+
+    void ImguiDrawer::PrepareFrame(RenderResources& frame, ImDrawData* drawData, ImTextureID fontTextureId, FrameStats& frameStats)
+    {
+        // bindings of destroyed textures may still be referenced by frames in flight
+        for (ShaderBindingPtr& binding : m_invalidatedTextureBindings)
+            frame.PushForRelease(std::move(binding));
+
+        m_invalidatedTextureBindings.clear();
+
+        // the previous frame read the buffer set its commands were recorded with, which stays the case while they're replayed
+        m_frameBuffers[m_recordedFrameBuffers].lastUsedFrame = m_frameIndex - 1;
+
+        // each frame writes into a buffer set no frame still in flight reads from, one is always free since a frame reads a single set
+        do
+            m_currentFrameBuffers = (m_currentFrameBuffers + 1) % FrameInFlightCount;
+        while (m_frameBuffers[m_currentFrameBuffers].lastUsedFrame != 0 && m_frameBuffers[m_currentFrameBuffers].lastUsedFrame + FrameInFlightCount > m_frameIndex);
+
+        // the size comes from the draw data, io may already describe the next frame
+        m_framebufferSize = Vector2i::Zero();
+        if (drawData == nullptr)
             return;
 
-		ImGuiIO& io = ImGui::GetIO();
-		assert(io.Fonts->TexID != (ImTextureID)NULL);  // You forgot to create and set font texture
+		int fb_width = static_cast<int>(drawData->DisplaySize.x * drawData->FramebufferScale.x);
+		int fb_height = static_cast<int>(drawData->DisplaySize.y * drawData->FramebufferScale.y);
+		m_framebufferSize = Vector2i(fb_width, fb_height);
+
+        if (drawData->CmdListsCount == 0)
+            return;
 
-		// scale stuff (needed for proper handling of window resize)
-		int fb_width = static_cast<int>(io.DisplaySize.x * io.DisplayFramebufferScale.x);
-		int fb_height = static_cast<int>(io.DisplaySize.y * io.DisplayFramebufferScale.y);
-		if (fb_width == 0 || fb_height == 0)
+		assert(fontTextureId != (ImTextureID)NULL);  // You forgot to create and set font texture
+
+		if (fb_width <= 0 || fb_height <= 0)
 			return;
 
-		ImguiUbo ubo{ fb_width / 2.f, fb_height / 2.f };
-		auto& allocation = frame.GetUploadPool().Allocate(sizeof(ImguiUbo));
+		EnsurePipelinesLoaded();
+
+		// the ubo only holds the framebuffer size, copying it again is only needed after a resize
+		Vector2i framebufferSize(fb_width, fb_height);
+		if (framebufferSize != m_uboFramebufferSize)
+		{
+			ImguiUbo ubo{ fb_width / 2.f, fb_height / 2.f };
+			auto& allocation = frame.GetUploadPool().Allocate(sizeof(ImguiUbo));
 
-		std::memcpy(allocation.mappedPtr, &ubo, sizeof(ImguiUbo));
+			std::memcpy(allocation.mappedPtr, &ubo, sizeof(ImguiUbo));
+			frameStats.uploadedBytes += sizeof(ImguiUbo);
 
-		frame.Execute([&](Nz::CommandBufferBuilder& builder)
-			{
-				builder.BeginDebugRegion("Imgui UBO Update", Nz::Color::Yellow());
+			frame.Execute([&](Nz::CommandBufferBuilder& builder)
 				{
-					builder.PreTransferBarrier();
-					builder.CopyBuffer(allocation, m_uboBuffer.get());
-					builder.PostTransferBarrier();
-				}
-				builder.EndDebugRegion();
-			}, Nz::QueueType::Transfer);
+					builder.BeginDebugRegion("Imgui UBO Update", Nz::Color::Yellow());
+					{
+						builder.PreTransferBarrier();
+						builder.CopyBuffer(allocation, m_uboBuffer.get());
+						builder.PostTransferBarrier();
+					}
+					builder.EndDebugRegion();
+				}, Nz::QueueType::Transfer);
 
-        drawData->ScaleClipRects(io.DisplayFramebufferScale);
+			m_uboFramebufferSize = framebufferSize;
+		}
 
-        // first pass over cmd lists to prepare buffers
-        std::vector<Nz::VertexStruct_XYZ_Color_UV> vertices;
-        std::vector<uint16_t> indices;
-        for (int n = 0; n < drawData->CmdListsCount; ++n) {
-            const ImDrawList* cmd_list = drawData->CmdLists[n];
+        // buffers are sized for the whole frame up front, so draw lists can be uploaded in place
+        FrameBuffers& frameBuffers = m_frameBuffers[m_currentFrameBuffers];
 
-            DrawCall drawCall;
-            drawCall.vertex_offset = vertices.size();
-            drawCall.indice_offset = indices.size();
+        RenderBuffer* previousVertexBuffer = frameBuffers.vertexBuffer.buffer.get();
+        RenderBuffer* previousIndexBuffer = frameBuffers.indexBuffer.buffer.get();
 
-            vertices.reserve(vertices.size() + cmd_list->VtxBuffer.size());
-            for (auto& vertex : cmd_list->VtxBuffer)
-                vertices.push_back({ ToNzVec3(vertex.pos), ToNzColor(vertex.col), ToNzVec2(vertex.uv) });
+        if (!EnsureBufferCapacity(frame, frameBuffers.vertexBuffer, Nz::BufferType::Vertex, UInt64(drawData->TotalVtxCount) * sizeof(ImDrawVert)))
+            throw std::runtime_error("Failed to allocate imgui vertex buffer");
 
-            indices.reserve(indices.size() + cmd_list->IdxBuffer.size());
-            for (auto indice : cmd_list->IdxBuffer)
-                indices.push_back(uint16_t(drawCall.vertex_offset + indice));
+        if (!EnsureBufferCapacity(frame, frameBuffers.indexBuffer, Nz::BufferType::Index, UInt64(drawData->TotalIdxCount) * sizeof(ImDrawIdx)))
+            throw std::runtime_error("Failed to allocate imgui index buffer");
 
-            for (auto& cmd : cmd_list->CmdBuffer)
-                drawCall.cmdBuffer.push_back(cmd);
+        // a new buffer holds none of the previous uploads
+        if (frameBuffers.vertexBuffer.buffer.get() != previousVertexBuffer || frameBuffers.indexBuffer.buffer.get() != previousIndexBuffer)
+            frameBuffers.uploadCache.clear();
+
+        // only draw lists which changed since this buffer set was last used are uploaded
+        std::size_t dirtyDrawListCount = m_drawListCompiler.PrepareDrawLists(*drawData, frameBuffers.uploadCache);
+        if (dirtyDrawListCount > 0)
+        {
+            void* vertices = frameBuffers.vertexBuffer.buffer->Map(0, frameBuffers.vertexBuffer.capacity);
+            void* indices = frameBuffers.indexBuffer.buffer->Map(0, frameBuffers.indexBuffer.capacity);
+            if (!vertices || !indices)
+                throw std::runtime_error("Failed to map imgui buffers");
 
-            m_drawCalls.push_back(std::move(drawCall));
+            m_drawListCompiler.UploadDrawLists(vertices, indices, frameBuffers.uploadCache);
+
+            frameBuffers.vertexBuffer.buffer->Unmap();
+            frameBuffers.indexBuffer.buffer->Unmap();
         }
 
-        frame.PushForRelease(std::move(m_vertexBuffer));
-        frame.PushForRelease(std::move(m_indexBuffer));
+        // only the font atlas may hold coverage in a single channel, user textures are always sampled as rgba
+        // whatever their format
+        const Texture* fontTexture = static_cast<const Texture*>(fontTextureId);
+        bool alphaFontTexture = (fontTexture && fontTexture->GetFormat() == PixelFormat::R8);
 
-        // now that we have macro buffers, allocate them on gpu
-        size_t size = vertices.size() * sizeof(Nz::VertexStruct_XYZ_Color_UV);
-        m_vertexBuffer = m_renderDevice.InstantiateBuffer(Nz::BufferType::Vertex, size, Nz::BufferUsage::DeviceLocal | Nz::BufferUsage::Dynamic, vertices.data());
-        size = indices.size() * sizeof(uint16_t);
-        m_indexBuffer = m_renderDevice.InstantiateBuffer(Nz::BufferType::Index, size, Nz::BufferUsage::DeviceLocal | Nz::BufferUsage::Dynamic, indices.data());
+        // untextured commands sample a white texture so the whole frame can go through the textured pipeline,
+        // its format follows the font atlas so text and untextured shapes also share the R8 variant
+        Texture* whiteTexture = nullptr;
+        if (m_singlePipeline)
+            whiteTexture = GetWhiteTexture(frame, (alphaFontTexture) ? PixelFormat::R8 : PixelFormat::RGBA8);
 
-	}
+        // commands are compiled on this thread since texture bindings are created on demand
+        m_drawListCompiler.CompileCommands([&](ImTextureID textureId) -> ImguiDrawListCompiler::DrawState
+        {
+            Texture* texture = static_cast<Texture*>(textureId);
+            if (!texture)
+                texture = whiteTexture;
+
+            if (texture)
+            {
+                bool alphaTexture = alphaFontTexture && (texture == fontTexture || texture == whiteTexture);
+                const RenderPipeline* pipeline = (alphaTexture) ? m_texturedPipeline.alphaPipeline.get() : m_texturedPipeline.pipeline.get();
+                return { pipeline, m_texturedPipeline.uboShaderBinding.get(), GetTextureShaderBinding(frame, texture) };
+            }
+            else
+                return { m_untexturedPipeline.pipeline.get(), m_untexturedPipeline.uboShaderBinding.get(), nullptr };
+        }, drawData->FramebufferScale);
+
+        // what is drawn only depends on the draw lists, which textures they use and where
+        m_frameFingerprint = ImguiFingerprint::Compute(&framebufferSize, sizeof(framebufferSize), m_drawListCompiler.GetFrameFingerprint());
+
+        const auto& commandStats = m_drawListCompiler.GetCommandStats();
+        frameStats.drawListCount = std::size_t(drawData->CmdListsCount);
+        frameStats.dirtyDrawListCount = dirtyDrawListCount;
+        frameStats.vertexCount = std::size_t(drawData->TotalVtxCount);
+        frameStats.indexCount = std::size_t(drawData->TotalIdxCount);
+        frameStats.drawCallCount = commandStats.drawCallCount;
+        frameStats.pipelineChangeCount = commandStats.pipelineChangeCount;
+        frameStats.shaderBindingChangeCount = commandStats.shaderBindingChangeCount;
+        frameStats.skippedStateChangeCount = commandStats.skippedStateChangeCount;
+        frameStats.uploadedBytes += m_drawListCompiler.GetDirtyGeometrySize();
+    }
 
     void ImguiDrawer::Draw(CommandBufferBuilder& builder)
     {
-        if (m_drawCalls.empty())
+        DrawCommands(builder, false);
+    }
+
+    void ImguiDrawer::DrawCommands(CommandBufferBuilder& builder, bool intoLayer)
+    {
+        const auto& drawCommands = m_drawListCompiler.GetCommands();
+        if (drawCommands.empty())
             return;
 
-        ImGuiIO& io = ImGui::GetIO();
-        int fb_width = static_cast<int>(io.DisplaySize.x * io.DisplayFramebufferScale.x);
-        int fb_height = static_cast<int>(io.DisplaySize.y * io.DisplayFramebufferScale.y);
+        auto start = std::chrono::steady_clock::now();
 
-        builder.SetViewport(Nz::Recti{ 0, 0, fb_width, fb_height });
-        builder.BindIndexBuffer(*m_indexBuffer, Nz::IndexType::U16);
-        builder.BindVertexBuffer(0, *m_vertexBuffer);
+        builder.SetViewport(Nz::Recti{ 0, 0, m_framebufferSize.x, m_framebufferSize.y });
 
-        for (auto& drawCall : m_drawCalls)
+        m_recordedFrameBuffers = m_currentFrameBuffers;
+
+        const FrameBuffers& frameBuffers = m_frameBuffers[m_currentFrameBuffers];
+        builder.BindIndexBuffer(*frameBuffers.indexBuffer.buffer, ImguiIndexType);
+
+        using DrawCommand = ImguiDrawListCompiler::DrawCommand;
+        for (const DrawCommand& drawCommand : drawCommands)
         {
-            Nz::UInt64 indexOffset = drawCall.indice_offset;
-            for (auto& cmd : drawCall.cmdBuffer)
+            if (drawCommand.stateChanges & DrawCommand::VertexBufferChange)
+                builder.BindVertexBuffer(0, *frameBuffers.vertexBuffer.buffer, drawCommand.vertexBufferOffset);
+
+            if (drawCommand.stateChanges & DrawCommand::PipelineChange)
             {
-                if (!cmd.UserCallback)
-                {
-                    auto rect = cmd.ClipRect;
-                    auto count = cmd.ElemCount;
-                    auto texture = static_cast<Nz::Texture*>(cmd.GetTexID());
-
-                    if (nullptr != texture)
-                    {
-                        if (std::end(m_texturedPipeline.textureShaderBindings) == m_texturedPipeline.textureShaderBindings.find(texture))
-                        {
-                            auto binding = m_texturedPipeline.pipeline->GetPipelineInfo().pipelineLayout->AllocateShaderBinding(1);
-                            binding->Update({
-                                {
-                                    0,
-                                    Nz::ShaderBinding::SampledTextureBinding {
-                                        texture, m_texturedPipeline.textureSampler.get()
-                                    }
-                                }
-                                });
-                            m_texturedPipeline.textureShaderBindings[texture] = std::move(binding);
-                        }
-
-                        builder.BindRenderPipeline(*m_texturedPipeline.pipeline);
-                        builder.BindRenderShaderBinding(0, *m_texturedPipeline.uboShaderBinding);
-                        builder.BindRenderShaderBinding(1, *m_texturedPipeline.textureShaderBindings[texture]);
-                    }
-                    else
-                    {
-                        builder.BindRenderPipeline(*m_untexturedPipeline.pipeline);
-                        builder.BindRenderShaderBinding(0, *m_untexturedPipeline.uboShaderBinding);
-                    }
-
-                    builder.SetScissor(Nz::Recti{ int(rect.x), int(rect.y), int(rect.z - rect.x), int(rect.w - rect.y) });// Nz::Recti{ int(rect.x), int(fb_height - rect.w), int(rect.z - rect.x), int(rect.w - rect.y) });
-
-                    builder.DrawIndexed(count, 1, Nz::UInt32(indexOffset));
-                }
-                indexOffset += cmd.ElemCount;
+                builder.BindRenderPipeline((intoLayer) ? GetLayerPipeline(*drawCommand.pipeline) : *drawCommand.pipeline);
+                builder.BindRenderShaderBinding(0, *drawCommand.uboBinding);
             }
+
+            if (drawCommand.stateChanges & DrawCommand::TextureBindingChange)
+                builder.BindRenderShaderBinding(1, *drawCommand.textureBinding);
+
+            if (drawCommand.stateChanges & DrawCommand::ScissorChange)
+                builder.SetScissor(drawCommand.scissor);
+
+            builder.DrawIndexed(drawCommand.indexCount, 1, drawCommand.firstIndex);
+        }
+
+        m_frameStats[m_frameIndex % FrameStatsHistorySize].drawTime = std::chrono::steady_clock::now() - start;
+    }
+
+    const ImguiDrawer::FrameStats& ImguiDrawer::GetFrameStats(std::size_t age) const
+    {
+        assert(age < FrameStatsHistorySize);
+        return m_frameStats[(m_frameIndex + FrameStatsHistorySize - age) % FrameStatsHistorySize];
+    }
+
+    void ImguiDrawer::RenderLayer(RenderResources& frame)
+    {
+        Vector2i size = m_framebufferSize;
+
+        ImguiLayerState::Update update = m_layer.state.Prepare(size, m_frameChanged);
+        if (update == ImguiLayerState::Update::None || update == ImguiLayerState::Update::Reuse)
+            return;
+
+        if (update == ImguiLayerState::Update::Create)
+            CreateLayer(frame, size);
+
+        frame.Execute([&](CommandBufferBuilder& builder)
+            {
+                CommandBufferBuilder::ClearValues clearValue;
+                clearValue.color = Color(0.f, 0.f, 0.f, 0.f);
+
+                builder.BeginDebugRegion("Imgui layer", Color::Green());
+                builder.BeginRenderPass(*m_layer.framebuffer, *m_layer.renderPass, Recti(0, 0, size.x, size.y), &clearValue, 1);
+                DrawCommands(builder, true);
+                builder.EndRenderPass();
+                builder.EndDebugRegion();
+            }, QueueType::Graphics);
+    }
+
+    void ImguiDrawer::DrawLayer(CommandBufferBuilder& builder)
+    {
+        if (!m_layer.state.IsUpToDate())
+            return;
+
+        builder.SetViewport(Recti{ 0, 0, m_layer.size.x, m_layer.size.y });
+        builder.BindRenderPipeline(*m_compositePipeline.pipeline);
+        builder.BindRenderShaderBinding(0, *m_layer.binding);
+        builder.BindVertexBuffer(0, *m_compositePipeline.quadVertexBuffer);
+        builder.Draw(4);
+    }
+
+    void ImguiDrawer::CreateLayer(RenderResources& frame, const Vector2i& size)
+    {
+        EnsurePipelinesLoaded();
+        if (!m_compositePipeline.pipeline)
+            LoadCompositePipeline();
+
+        // the previous layer may still be sampled by frames in flight
+        if (m_layer.texture)
+        {
+            frame.PushForRelease(std::move(m_layer.binding));
+            frame.PushForRelease(std::move(m_layer.framebuffer));
+            frame.PushForRelease(std::move(m_layer.texture));
+        }
+
+        if (!m_layer.renderPass)
+        {
+            std::vector<RenderPass::Attachment> attachments(1);
+            attachments[0].format = PixelFormat::RGBA8;
+            attachments[0].loadOp = AttachmentLoadOp::Clear;
+            attachments[0].storeOp = AttachmentStoreOp::Store;
+            attachments[0].stencilLoadOp = AttachmentLoadOp::Discard;
+            attachments[0].stencilStoreOp = AttachmentStoreOp::Discard;
+            attachments[0].initialLayout = TextureLayout::Undefined;
+            attachments[0].finalLayout = TextureLayout::ColorInput;
+
+            std::vector<RenderPass::SubpassDescription> subpasses(1);
+            subpasses[0].colorAttachment.push_back({ 0, TextureLayout::ColorOutput });
+
+            // the layer is sampled by the composite of the previous frames, and by the one of this frame once rendered
+            std::vector<RenderPass::SubpassDependency> dependencies(2);
+            dependencies[0].fromSubpassIndex = RenderPass::ExternalSubpassIndex;
+            dependencies[0].fromStages = PipelineStage::FragmentShader;
+            dependencies[0].fromAccessFlags = MemoryAccess::ShaderRead;
+            dependencies[0].toSubpassIndex = 0;
+            dependencies[0].toStages = PipelineStage::ColorOutput;
+            dependencies[0].toAccessFlags = MemoryAccess::ColorWrite;
+            dependencies[0].tilable = false;
+
+            dependencies[1].fromSubpassIndex = 0;
+            dependencies[1].fromStages = PipelineStage::ColorOutput;
+            dependencies[1].fromAccessFlags = MemoryAccess::ColorWrite;
+            dependencies[1].toSubpassIndex = RenderPass::ExternalSubpassIndex;
+            dependencies[1].toStages = PipelineStage::FragmentShader;
+            dependencies[1].toAccessFlags = MemoryAccess::ShaderRead;
+            dependencies[1].tilable = false;
+
+            m_layer.renderPass = m_renderDevice.InstantiateRenderPass(std::move(attachments), std::move(subpasses), std::move(dependencies));
         }
+
+        TextureInfo texParams;
+        texParams.width = size.x;
+        texParams.height = size.y;
+        texParams.pixelFormat = PixelFormat::RGBA8;
+        texParams.type = ImageType::E2D;
+        texParams.usageFlags = TextureUsage::ColorAttachment | TextureUsage::ShaderSampling;
+
+        m_layer.texture = m_renderDevice.InstantiateTexture(texParams);
+        if (!m_layer.texture)
+            throw std::runtime_error("Failed to create imgui layer texture");
+
+        m_layer.texture->UpdateDebugName("ImguiLayer");
+
+        m_layer.framebuffer = m_renderDevice.InstantiateFramebuffer(size.x, size.y, m_layer.renderPass, { m_layer.texture });
+
+        m_layer.binding = m_compositePipeline.pipeline->GetPipelineInfo().pipelineLayout->AllocateShaderBinding(0);
+        m_layer.binding->Update({
+            {
+                0,
+                Nz::ShaderBinding::SampledTextureBinding {
+                    m_layer.texture.get(), m_texturedPipeline.textureSampler.get()
+                }
+            }
+            });
+
+        m_layer.size = size;
+    }
+
+    const RenderPipeline& ImguiDrawer::GetLayerPipeline(const RenderPipeline& pipeline) const
+    {
+        if (&pipeline == m_texturedPipeline.alphaPipeline.get())
+            return *m_texturedPipeline.layerAlphaPipeline;
+        else if (&pipeline == m_untexturedPipeline.pipeline.get())
+            return *m_untexturedPipeline.layerPipeline;
+        else
+            return *m_texturedPipeline.layerPipeline;
+    }
+
+    void ImguiDrawer::LoadPipelinesAsync()
+    {
+        if (m_pipelinesLoaded || m_internals->pipelineLoading.valid())
+            return;
+
+        // the loading thread doesn't touch the drawer nor the render device
+        m_internals->pipelineLoading = std::async(std::launch::async, &ImguiDrawer::LoadPipelineShaderModules);
+    }
+
+    void ImguiDrawer::EnsurePipelinesLoaded()
+    {
+        if (m_pipelinesLoaded)
+            return;
+
+        // rethrows what the loading thread threw
+        PipelineShaderModules shaderModules = (m_internals->pipelineLoading.valid()) ? m_internals->pipelineLoading.get() : LoadPipelineShaderModules();
+
+        LoadTexturedPipeline(*shaderModules.textured);
+        LoadUntexturedPipeline(*shaderModules.untextured);
+
+        m_pipelinesLoaded = true;
+    }
+
+    ImguiDrawer::PipelineShaderModules ImguiDrawer::LoadPipelineShaderModules()
+    {
+        PipelineShaderModules shaderModules;
+
+        nzsl::Deserializer texturedDeserializer(shaderBinary_Textured, sizeof(shaderBinary_Textured));
+        shaderModules.textured = nzsl::Ast::DeserializeShader(texturedDeserializer);
+        if (!shaderModules.textured)
+            throw std::runtime_error("Failed to load shader module");
+
+        nzsl::Deserializer untexturedDeserializer(shaderBinary_Untextured, sizeof(shaderBinary_Untextured));
+        shaderModules.untextured = nzsl::Ast::DeserializeShader(untexturedDeserializer);
+        if (!shaderModules.untextured)
+            throw std::runtime_error("Failed to load shader module");
+
+        return shaderModules;
     }
 
     void ImguiDrawer::Reset(RenderResources& /*renderFrame*/)
     {
-        m_drawCalls.clear();
+        m_drawListCompiler.Clear();
+    }
+
+    void ImguiDrawer::SetSinglePipeline(bool singlePipeline)
+    {
+        if (m_singlePipeline != singlePipeline)
+            m_redrawRequested = true;
+
+        m_singlePipeline = singlePipeline;
+    }
+
+    void ImguiDrawer::SetTextureBindingBudget(std::size_t budget)
+    {
+        // eviction happens on next bind, bindings may still be in use by the frame being recorded
+        m_textureBindingBudget = std::max<std::size_t>(budget, 1);
+    }
+
+    void ImguiDrawer::InvalidateTexture(const Texture* texture)
+    {
+        auto it = m_internals->textureBindingByTexture.find(texture);
+        if (it == m_internals->textureBindingByTexture.end())
+            return;
+
+        m_redrawRequested = true;
+
+        m_invalidatedTextureBindings.push_back(std::move(it->second->binding));
+        m_internals->textureBindings.erase(it->second);
+        m_internals->textureBindingByTexture.erase(it);
+
+        m_textureBindingCacheStats.invalidations++;
+        m_textureBindingCacheStats.size = m_internals->textureBindings.size();
     }
 
-    bool ImguiDrawer::LoadTexturedPipeline()
+    Texture* ImguiDrawer::GetWhiteTexture(RenderResources& frame, PixelFormat format)
     {
-        nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(std::string_view(shaderSource_Textured, sizeof(shaderSource_Textured)));
+        if (m_whiteTexture && m_whiteTexture->GetFormat() == format)
+            return m_whiteTexture.get();
+
+        // the previous texture may still be sampled by frames in flight
+        if (m_whiteTexture)
+        {
+            InvalidateTexture(m_whiteTexture.get());
+            frame.PushForRelease(std::move(m_whiteTexture));
+        }
+
+        const UInt8 whitePixel[] = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+        TextureInfo texParams;
+        texParams.width = 1;
+        texParams.height = 1;
+        texParams.pixelFormat = format;
+        texParams.type = ImageType::E2D;
+
+        m_whiteTexture = m_renderDevice.InstantiateTexture(texParams, whitePixel, false);
+        if (!m_whiteTexture)
+            throw std::runtime_error("Failed to create imgui white texture");
+
+        m_whiteTexture->UpdateDebugName("ImguiWhiteTexture");
+
+        return m_whiteTexture.get();
+    }
+
+    const ShaderBinding* ImguiDrawer::GetTextureShaderBinding(RenderResources& frame, Texture* texture)
+    {
+        auto it = m_internals->textureBindingByTexture.find(texture);
+        if (it != m_internals->textureBindingByTexture.end())
+        {
+            TextureBinding& textureBinding = *it->second;
+
+            // a texture not invalidated before its destruction may have had its address reused, catch what we can
+            if (textureBinding.textureSize == texture->GetSize() && textureBinding.textureFormat == texture->GetFormat())
+            {
+                if (it->second != m_internals->textureBindings.begin())
+                    m_internals->textureBindings.splice(m_internals->textureBindings.begin(), m_internals->textureBindings, it->second);
+
+                textureBinding.lastUsedFrame = m_frameIndex;
+                m_textureBindingCacheStats.hits++;
+                return textureBinding.binding.get();
+            }
+
+            frame.PushForRelease(std::move(textureBinding.binding));
+            m_internals->textureBindings.erase(it->second);
+            m_internals->textureBindingByTexture.erase(it);
+            m_textureBindingCacheStats.invalidations++;
+        }
+
+        m_textureBindingCacheStats.misses++;
+
+        // recorded commands can't be replayed with a binding they don't reference, nor with an evicted one
+        m_redrawRequested = true;
+
+        // evict least recently used bindings, except those already referenced by this frame
+        while (m_internals->textureBindings.size() >= m_textureBindingBudget && m_internals->textureBindings.back().lastUsedFrame != m_frameIndex)
+        {
+            TextureBinding& evictedBinding = m_internals->textureBindings.back();
+            frame.PushForRelease(std::move(evictedBinding.binding));
+            m_internals->textureBindingByTexture.erase(evictedBinding.texture);
+            m_internals->textureBindings.pop_back();
+
+            m_textureBindingCacheStats.evictions++;
+        }
+
+        auto binding = m_texturedPipeline.pipeline->GetPipelineInfo().pipelineLayout->AllocateShaderBinding(1);
+        binding->Update({
+            {
+                0,
+                Nz::ShaderBinding::SampledTextureBinding {
+                    texture, m_texturedPipeline.textureSampler.get()
+                }
+            }
+            });
+
+        TextureBinding& textureBinding = m_internals->textureBindings.emplace_front();
+        textureBinding.texture = texture;
+        textureBinding.binding = std::move(binding);
+        textureBinding.textureSize = texture->GetSize();
+        textureBinding.textureFormat = texture->GetFormat();
+        textureBinding.lastUsedFrame = m_frameIndex;
+
+        m_internals->textureBindingByTexture.emplace(texture, m_internals->textureBindings.begin());
+        m_textureBindingCacheStats.size = m_internals->textureBindings.size();
+
+        return textureBinding.binding.get();
+    }
+
+    bool ImguiDrawer::EnsureBufferCapacity(RenderResources& frame, GrowableBuffer& buffer, BufferType bufferType, UInt64 size)
+    {
+        constexpr UInt64 MinBufferSize = 64 * 1024;
+        constexpr unsigned int ShrinkFrameDelay = 300;
+
+        size = std::max(size, MinBufferSize);
+
+        if (size <= buffer.capacity)
+        {
+            // only give memory back after a sustained drop, to avoid reallocating on every spike
+            if (size * 4 > buffer.capacity)
+            {
+                buffer.underusedFrameCount = 0;
+                return true;
+            }
+
+            if (++buffer.underusedFrameCount < ShrinkFrameDelay)
+                return true;
+        }
+
+        // grow geometrically so a slowly growing ui settles on a stable buffer size
+        UInt64 capacity = std::bit_ceil(size);
+        if (size > buffer.capacity)
+            capacity = std::max(capacity, buffer.capacity * 2);
+
+        if (buffer.buffer)
+            frame.PushForRelease(std::move(buffer.buffer));
+
+        // only dirty draw lists are written when mapped, the buffer has to be host visible so the others keep their content
+        // (without DirectMapping, Map returns an uninitialized staging buffer which Unmap copies over the whole range)
+        buffer.buffer = m_renderDevice.InstantiateBuffer(bufferType, capacity, Nz::BufferUsage::DeviceLocal | Nz::BufferUsage::Dynamic | Nz::BufferUsage::DirectMapping);
+        if (!buffer.buffer)
+        {
+            buffer.capacity = 0;
+            return false;
+        }
+
+        buffer.capacity = capacity;
+        buffer.underusedFrameCount = 0;
+        return true;
+    }
+
+    void ImguiDrawer::LoadCompositePipeline()
+    {
+        nzsl::Deserializer deserializer(shaderBinary_Composite, sizeof(shaderBinary_Composite));
+        nzsl::Ast::ModulePtr shaderModule = nzsl::Ast::DeserializeShader(deserializer);
         if (!shaderModule)
-            throw std::runtime_error("Failed to parse shader module");
+            throw std::runtime_error("Failed to load shader module");
 
         nzsl::ShaderWriter::States states;
-        states.optimize = true;
 
         auto shader = m_renderDevice.InstantiateShaderModule(nzsl::ShaderStageType::Fragment | nzsl::ShaderStageType::Vertex, *shaderModule, states);
         if (!shader)
             throw std::runtime_error("Failed to instantiate shader");
 
+        Nz::RenderPipelineLayoutInfo pipelineLayoutInfo;
+
+        auto& layerBinding = pipelineLayoutInfo.bindings.emplace_back();
+        layerBinding.setIndex = 0;
+        layerBinding.bindingIndex = 0;
+        layerBinding.shaderStageFlags = nzsl::ShaderStageType::Fragment;
+        layerBinding.type = Nz::ShaderBindingType::Sampler;
+
+        std::shared_ptr<Nz::RenderPipelineLayout> renderPipelineLayout = m_renderDevice.InstantiateRenderPipelineLayout(std::move(pipelineLayoutInfo));
+
+        Nz::RenderPipelineInfo pipelineInfo;
+        pipelineInfo.pipelineLayout = renderPipelineLayout;
+        pipelineInfo.shaderModules.emplace_back(shader);
+
+        pipelineInfo.depthBuffer = false;
+        pipelineInfo.faceCulling = Nz::FaceCulling::None;
+        pipelineInfo.primitiveMode = Nz::PrimitiveMode::TriangleStrip;
+
+        // the layer was rendered over transparent black, its colors are premultiplied by alpha
+        pipelineInfo.blending = true;
+        pipelineInfo.blend.modeAlpha = Nz::BlendEquation::Add;
+        pipelineInfo.blend.srcColor = Nz::BlendFunc::One;
+        pipelineInfo.blend.dstColor = Nz::BlendFunc::InvSrcAlpha;
+        pipelineInfo.blend.srcAlpha = Nz::BlendFunc::One;
+        pipelineInfo.blend.dstAlpha = Nz::BlendFunc::InvSrcAlpha;
+
+        auto& pipelineVertexBuffer = pipelineInfo.vertexBuffers.emplace_back();
+        pipelineVertexBuffer.binding = 0;
+        pipelineVertexBuffer.declaration = m_vertexDeclaration;
+
+        m_compositePipeline.pipeline = m_renderDevice.InstantiateRenderPipeline(pipelineInfo);
+
+        // fullscreen quad as a triangle strip, positions are in clip space
+        const ImDrawVert quadVertices[] = {
+            { ImVec2(-1.f, -1.f), ImVec2(0.f, 0.f), IM_COL32_WHITE },
+            { ImVec2( 1.f, -1.f), ImVec2(1.f, 0.f), IM_COL32_WHITE },
+            { ImVec2(-1.f,  1.f), ImVec2(0.f, 1.f), IM_COL32_WHITE },
+            { ImVec2( 1.f,  1.f), ImVec2(1.f, 1.f), IM_COL32_WHITE }
+        };
+
+        m_compositePipeline.quadVertexBuffer = m_renderDevice.InstantiateBuffer(Nz::BufferType::Vertex, sizeof(quadVertices), Nz::BufferUsage::DeviceLocal, quadVertices);
+        if (!m_compositePipeline.quadVertexBuffer)
+            throw std::runtime_error("Failed to allocate imgui layer quad");
+    }
+
+    bool ImguiDrawer::LoadTexturedPipeline(const nzsl::Ast::Module& shaderModule)
+    {
+        nzsl::ShaderWriter::States states;
+
+        auto shader = m_renderDevice.InstantiateShaderModule(nzsl::ShaderStageType::Fragment | nzsl::ShaderStageType::Vertex, shaderModule, states);
+        if (!shader)
+            throw std::runtime_error("Failed to instantiate shader");
+
+        states.optionValues[nzsl::Ast::HashOption("AlphaTexture")] = true;
+
+        auto alphaShader = m_renderDevice.InstantiateShaderModule(nzsl::ShaderStageType::Fragment | nzsl::ShaderStageType::Vertex, shaderModule, states);
+        if (!alphaShader)
+            throw std::runtime_error("Failed to instantiate shader");
+
         m_texturedPipeline.textureSampler = m_renderDevice.InstantiateTextureSampler({});
 
         Nz::RenderPipelineLayoutInfo pipelineLayoutInfo;
@@ -246,10 +805,25 @@ namespace Nz
 
         auto& pipelineVertexBuffer = pipelineInfo.vertexBuffers.emplace_back();
         pipelineVertexBuffer.binding = 0;
-        pipelineVertexBuffer.declaration = Nz::VertexDeclaration::Get(Nz::VertexLayout::XYZ_Color_UV);
+        pipelineVertexBuffer.declaration = m_vertexDeclaration;
 
         m_texturedPipeline.pipeline = m_renderDevice.InstantiateRenderPipeline(pipelineInfo);
 
+        // same layout, so texture and ubo bindings are shared between both pipelines
+        pipelineInfo.shaderModules.clear();
+        pipelineInfo.shaderModules.emplace_back(alphaShader);
+
+        m_texturedPipeline.alphaPipeline = m_renderDevice.InstantiateRenderPipeline(pipelineInfo);
+
+        // the layer accumulates coverage in its alpha, so it can be composited over the scene
+        pipelineInfo.blend.dstAlpha = Nz::BlendFunc::InvSrcAlpha;
+        m_texturedPipeline.layerAlphaPipeline = m_renderDevice.InstantiateRenderPipeline(pipelineInfo);
+
+        pipelineInfo.shaderModules.clear();
+        pipelineInfo.shaderModules.emplace_back(shader);
+
+        m_texturedPipeline.layerPipeline = m_renderDevice.InstantiateRenderPipeline(pipelineInfo);
+
         m_uboBuffer = m_renderDevice.InstantiateBuffer(Nz::BufferType::Uniform, sizeof(ImguiUbo), Nz::BufferUsage::DeviceLocal | Nz::BufferUsage::Dynamic);
 
         m_texturedPipeline.uboShaderBinding = renderPipelineLayout->AllocateShaderBinding(0);
@@ -265,16 +839,11 @@ namespace Nz
         return true;
     }
 
-    bool ImguiDrawer::LoadUntexturedPipeline()
+    bool ImguiDrawer::LoadUntexturedPipeline(const nzsl::Ast::Module& shaderModule)
     {
-        nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(std::string_view(shaderSource_Untextured, sizeof(shaderSource_Untextured)));
-        if (!shaderModule)
-            throw std::runtime_error("Failed to parse shader module");
-
         nzsl::ShaderWriter::States states;
-        states.optimize = true;
 
-        auto shader = m_renderDevice.InstantiateShaderModule(nzsl::ShaderStageType::Fragment | nzsl::ShaderStageType::Vertex, *shaderModule, states);
+        auto shader = m_renderDevice.InstantiateShaderModule(nzsl::ShaderStageType::Fragment | nzsl::ShaderStageType::Vertex, shaderModule, states);
         if (!shader)
             throw std::runtime_error("Failed to instantiate shader");
 
@@ -305,10 +874,13 @@ namespace Nz
 
         auto& pipelineVertexBuffer = pipelineInfo.vertexBuffers.emplace_back();
         pipelineVertexBuffer.binding = 0;
-        pipelineVertexBuffer.declaration = Nz::VertexDeclaration::Get(Nz::VertexLayout::XYZ_Color_UV);
+        pipelineVertexBuffer.declaration = m_vertexDeclaration;
 
         m_untexturedPipeline.pipeline = m_renderDevice.InstantiateRenderPipeline(pipelineInfo);
 
+        pipelineInfo.blend.dstAlpha = Nz::BlendFunc::InvSrcAlpha;
+        m_untexturedPipeline.layerPipeline = m_renderDevice.InstantiateRenderPipeline(pipelineInfo);
+
         m_untexturedPipeline.uboShaderBinding = renderPipelineLayout->AllocateShaderBinding(0);
         m_untexturedPipeline.uboShaderBinding->Update({
             {
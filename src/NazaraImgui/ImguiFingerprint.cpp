@@ -0,0 +1,196 @@
+#include <NazaraImgui/ImguiFingerprint.hpp>
+
+#include <cassert>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NAZARA_IMGUI_FINGERPRINT_SSE2
+#define NAZARA_IMGUI_FINGERPRINT_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define NAZARA_IMGUI_FINGERPRINT_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NAZARA_IMGUI_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NAZARA_IMGUI_TARGET_AVX2
+#endif
+
+namespace Nz::ImguiFingerprint
+{
+	namespace
+	{
+#ifdef NAZARA_IMGUI_FINGERPRINT_SSE2
+		// SSE2 has no 32-bit low multiplication, build it from the two 32x32->64 ones
+		inline __m128i MulLo32(__m128i a, __m128i b)
+		{
+			__m128i even = _mm_mul_epu32(a, b);
+			__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+			return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+		}
+
+		inline __m128i RoundSSE2(__m128i lanes, __m128i value, __m128i prime1, __m128i prime2)
+		{
+			lanes = _mm_add_epi32(lanes, MulLo32(value, prime2));
+			lanes = _mm_or_si128(_mm_slli_epi32(lanes, 13), _mm_srli_epi32(lanes, 32 - 13));
+			return MulLo32(lanes, prime1);
+		}
+
+		void AccumulateStripesSSE2(UInt32* lanes, const UInt8* data, std::size_t stripeCount)
+		{
+			const __m128i prime1 = _mm_set1_epi32(int(Prime1));
+			const __m128i prime2 = _mm_set1_epi32(int(Prime2));
+
+			__m128i lanesLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+			__m128i lanesHigh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes + 4));
+			for (std::size_t stripe = 0; stripe < stripeCount; ++stripe)
+			{
+				lanesLow = RoundSSE2(lanesLow, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), prime1, prime2);
+				lanesHigh = RoundSSE2(lanesHigh, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), prime1, prime2);
+
+				data += StripeSize;
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), lanesLow);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 4), lanesHigh);
+		}
+
+		NAZARA_IMGUI_TARGET_AVX2 void AccumulateStripesAVX2(UInt32* lanes, const UInt8* data, std::size_t stripeCount)
+		{
+			const __m256i prime1 = _mm256_set1_epi32(int(Prime1));
+			const __m256i prime2 = _mm256_set1_epi32(int(Prime2));
+
+			__m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+			for (std::size_t stripe = 0; stripe < stripeCount; ++stripe)
+			{
+				__m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+				acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(value, prime2));
+				acc = _mm256_or_si256(_mm256_slli_epi32(acc, 13), _mm256_srli_epi32(acc, 32 - 13));
+				acc = _mm256_mullo_epi32(acc, prime1);
+
+				data += StripeSize;
+			}
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+		}
+
+		bool HasAVX2()
+		{
+#ifdef _MSC_VER
+			int cpuInfo[4];
+			__cpuid(cpuInfo, 0);
+			if (cpuInfo[0] < 7)
+				return false;
+
+			// AVX2 needs the OS to save ymm registers (OSXSAVE + XCR0)
+			__cpuid(cpuInfo, 1);
+			if ((cpuInfo[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+				return false;
+
+			__cpuidex(cpuInfo, 7, 0);
+			return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+#endif
+
+#ifdef NAZARA_IMGUI_FINGERPRINT_NEON
+		inline uint32x4_t RoundNEON(uint32x4_t lanes, uint32x4_t value, uint32x4_t prime1, uint32x4_t prime2)
+		{
+			lanes = vmlaq_u32(lanes, value, prime2);
+			lanes = vsriq_n_u32(vshlq_n_u32(lanes, 13), lanes, 32 - 13);
+			return vmulq_u32(lanes, prime1);
+		}
+
+		void AccumulateStripesNEON(UInt32* lanes, const UInt8* data, std::size_t stripeCount)
+		{
+			const uint32x4_t prime1 = vdupq_n_u32(Prime1);
+			const uint32x4_t prime2 = vdupq_n_u32(Prime2);
+
+			uint32x4_t lanesLow = vld1q_u32(lanes);
+			uint32x4_t lanesHigh = vld1q_u32(lanes + 4);
+			for (std::size_t stripe = 0; stripe < stripeCount; ++stripe)
+			{
+				lanesLow = RoundNEON(lanesLow, vreinterpretq_u32_u8(vld1q_u8(data)), prime1, prime2);
+				lanesHigh = RoundNEON(lanesHigh, vreinterpretq_u32_u8(vld1q_u8(data + 16)), prime1, prime2);
+
+				data += StripeSize;
+			}
+
+			vst1q_u32(lanes, lanesLow);
+			vst1q_u32(lanes + 4, lanesHigh);
+		}
+#endif
+
+		std::vector<Kernel> ListSupportedKernels()
+		{
+			std::vector<Kernel> kernels;
+			kernels.push_back({ &AccumulateStripesScalar, "Scalar" });
+
+#if defined(NAZARA_IMGUI_FINGERPRINT_SSE2)
+			kernels.push_back({ &AccumulateStripesSSE2, "SSE2" });
+			if (HasAVX2())
+				kernels.push_back({ &AccumulateStripesAVX2, "AVX2" });
+#elif defined(NAZARA_IMGUI_FINGERPRINT_NEON)
+			kernels.push_back({ &AccumulateStripesNEON, "NEON" });
+#endif
+
+			return kernels;
+		}
+
+		Kernel SelectKernel()
+		{
+#if defined(NAZARA_IMGUI_FINGERPRINT_SSE2)
+			if (HasAVX2())
+				return { &AccumulateStripesAVX2, "AVX2" };
+
+			return { &AccumulateStripesSSE2, "SSE2" };
+#elif defined(NAZARA_IMGUI_FINGERPRINT_NEON)
+			return { &AccumulateStripesNEON, "NEON" };
+#else
+			return { &AccumulateStripesScalar, "Scalar" };
+#endif
+		}
+
+		const Kernel& GetKernel()
+		{
+			static Kernel kernel = SelectKernel();
+			return kernel;
+		}
+	}
+
+	AccumulateStripesFunc GetAccumulateStripes()
+	{
+		return GetKernel().accumulate;
+	}
+
+	const char* GetKernelName()
+	{
+		return GetKernel().name;
+	}
+
+	std::span<const Kernel> GetSupportedKernels()
+	{
+		static std::vector<Kernel> kernels = ListSupportedKernels();
+		return kernels;
+	}
+
+	UInt64 Compute(const void* data, std::size_t size, UInt64 seed)
+	{
+		UInt64 hash = ComputeWith(GetKernel().accumulate, data, size, seed);
+
+#ifdef NAZARA_IMGUI_DEBUG
+		// SIMD kernels have to be bit-identical to the scalar one
+		assert(hash == ComputeReference(data, size, seed));
+#endif
+
+		return hash;
+	}
+}
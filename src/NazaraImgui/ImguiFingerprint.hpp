@@ -0,0 +1,107 @@
+#pragma once
+
+#include <Nazara/Prerequisites.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+/*
+    ImguiFingerprint.hpp
+    Fast non-cryptographic hash used to detect draw lists which didn't change since they were uploaded
+*/
+
+namespace Nz::ImguiFingerprint
+{
+    constexpr std::size_t LaneCount = 8;
+    constexpr std::size_t StripeSize = LaneCount * sizeof(UInt32);
+
+    constexpr UInt32 Prime1 = 0x9E3779B1U;
+    constexpr UInt32 Prime2 = 0x85EBCA77U;
+    constexpr UInt64 Prime64 = 0x100000001B3ULL;
+
+    inline UInt32 Load32(const UInt8* ptr)
+    {
+        UInt32 value;
+        std::memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    inline UInt32 Round(UInt32 lane, UInt32 value)
+    {
+        return std::rotl(lane + value * Prime2, 13) * Prime1;
+    }
+
+    inline void InitLanes(UInt32* lanes, UInt64 seed)
+    {
+        for (std::size_t i = 0; i < LaneCount; ++i)
+            lanes[i] = UInt32(seed) + UInt32(seed >> 32) + Prime1 * UInt32(i + 1);
+    }
+
+    // Lanes are independent, each 32-byte stripe feeds one 32-bit word to each of them
+    // This is the reference implementation, SIMD kernels must produce the exact same lanes
+    inline void AccumulateStripesScalar(UInt32* lanes, const UInt8* data, std::size_t stripeCount)
+    {
+        for (std::size_t stripe = 0; stripe < stripeCount; ++stripe)
+        {
+            for (std::size_t i = 0; i < LaneCount; ++i)
+                lanes[i] = Round(lanes[i], Load32(data + i * sizeof(UInt32)));
+
+            data += StripeSize;
+        }
+    }
+
+    inline UInt64 Finalize(const UInt32* lanes, const UInt8* tail, std::size_t tailSize, std::size_t totalSize)
+    {
+        UInt64 hash = UInt64(totalSize) * Prime64;
+        for (std::size_t i = 0; i < LaneCount; ++i)
+            hash = (hash ^ lanes[i]) * Prime64;
+
+        for (std::size_t i = 0; i < tailSize; ++i)
+            hash = (hash ^ tail[i]) * Prime64;
+
+        // final avalanche so nearby inputs spread over the whole value
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ULL;
+        hash ^= hash >> 33;
+
+        return hash;
+    }
+
+    using AccumulateStripesFunc = void(*)(UInt32* lanes, const UInt8* data, std::size_t stripeCount);
+
+    struct Kernel
+    {
+        AccumulateStripesFunc accumulate;
+        const char* name;
+    };
+
+    // Best kernel supported by the running CPU, selected once
+    AccumulateStripesFunc GetAccumulateStripes();
+    const char* GetKernelName();
+    // Every kernel the running CPU supports, starting with the scalar reference
+    std::span<const Kernel> GetSupportedKernels();
+
+    inline UInt64 ComputeWith(AccumulateStripesFunc accumulate, const void* data, std::size_t size, UInt64 seed)
+    {
+        const UInt8* bytes = static_cast<const UInt8*>(data);
+        std::size_t stripeCount = size / StripeSize;
+
+        UInt32 lanes[LaneCount];
+        InitLanes(lanes, seed);
+        accumulate(lanes, bytes, stripeCount);
+
+        std::size_t processed = stripeCount * StripeSize;
+        return Finalize(lanes, bytes + processed, size - processed, size);
+    }
+
+    inline UInt64 ComputeReference(const void* data, std::size_t size, UInt64 seed = 0)
+    {
+        return ComputeWith(&AccumulateStripesScalar, data, size, seed);
+    }
+
+    UInt64 Compute(const void* data, std::size_t size, UInt64 seed = 0);
+}
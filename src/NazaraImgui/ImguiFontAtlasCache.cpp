@@ -0,0 +1,392 @@
+#include <NazaraImgui/ImguiFontAtlasCache.hpp>
+
+#include <NazaraImgui/ImguiFingerprint.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace Nz::ImguiFontAtlasCache
+{
+	namespace
+	{
+		constexpr UInt32 CacheMagic = 0x41495A4E; // "NZIA"
+		constexpr UInt32 CacheVersion = 1;
+
+		template<typename T>
+		UInt64 HashValue(UInt64 hash, const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			return ImguiFingerprint::Compute(&value, sizeof(T), hash);
+		}
+
+		class CacheWriter
+		{
+		public:
+			template<typename T>
+			void Write(const T& value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				WriteBytes(&value, sizeof(T));
+			}
+
+			void WriteBytes(const void* data, std::size_t size)
+			{
+				const UInt8* bytes = static_cast<const UInt8*>(data);
+				m_data.insert(m_data.end(), bytes, bytes + size);
+			}
+
+			const std::vector<UInt8>& GetData() const { return m_data; }
+
+		private:
+			std::vector<UInt8> m_data;
+		};
+
+		class CacheReader
+		{
+		public:
+			CacheReader(const std::vector<UInt8>& data)
+				: m_data(data.data())
+				, m_remaining(data.size())
+			{
+			}
+
+			template<typename T>
+			bool Read(T& value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				return ReadBytes(&value, sizeof(T));
+			}
+
+			bool ReadBytes(void* data, std::size_t size)
+			{
+				if (size > m_remaining)
+					return false;
+
+				std::memcpy(data, m_data, size);
+				m_data += size;
+				m_remaining -= size;
+				return true;
+			}
+
+			std::size_t GetRemaining() const { return m_remaining; }
+
+		private:
+			const UInt8* m_data;
+			std::size_t m_remaining;
+		};
+
+		int GetFontIndex(const ImFontAtlas& atlas, const ImFont* font)
+		{
+			for (int i = 0; i < atlas.Fonts.Size; ++i)
+			{
+				if (atlas.Fonts[i] == font)
+					return i;
+			}
+
+			return -1;
+		}
+
+		struct CachedCustomRect
+		{
+			unsigned short width;
+			unsigned short height;
+			unsigned short x;
+			unsigned short y;
+			unsigned int glyphId;
+			float glyphAdvanceX;
+			ImVec2 glyphOffset;
+			int fontIndex;
+		};
+
+		struct CachedFont
+		{
+			float fontSize;
+			float ascent;
+			float descent;
+			int metricsTotalSurface;
+			ImWchar fallbackChar;
+			ImWchar ellipsisChar;
+			std::vector<ImFontGlyph> glyphs;
+		};
+	}
+
+	UInt64 ComputeKey(const ImFontAtlas& atlas, unsigned int bytesPerPixel)
+	{
+		// glyphs and custom rects are stored as-is, a different imgui version may lay them out differently
+		UInt64 hash = HashValue(0, UInt32(IMGUI_VERSION_NUM));
+		hash = HashValue(hash, UInt32(sizeof(ImFontGlyph)));
+		hash = HashValue(hash, UInt32(sizeof(ImWchar)));
+		hash = HashValue(hash, UInt32(bytesPerPixel));
+		hash = HashValue(hash, atlas.Flags);
+		hash = HashValue(hash, atlas.TexDesiredWidth);
+		hash = HashValue(hash, atlas.TexGlyphPadding);
+
+		hash = HashValue(hash, atlas.ConfigData.Size);
+		for (const ImFontConfig& config : atlas.ConfigData)
+		{
+			hash = ImguiFingerprint::Compute(config.FontData, std::size_t(config.FontDataSize), hash);
+			hash = HashValue(hash, config.FontNo);
+			hash = HashValue(hash, config.SizePixels);
+			hash = HashValue(hash, config.OversampleH);
+			hash = HashValue(hash, config.OversampleV);
+			hash = HashValue(hash, config.PixelSnapH);
+			hash = HashValue(hash, config.GlyphExtraSpacing);
+			hash = HashValue(hash, config.GlyphOffset);
+			hash = HashValue(hash, config.GlyphMinAdvanceX);
+			hash = HashValue(hash, config.GlyphMaxAdvanceX);
+			hash = HashValue(hash, config.MergeMode);
+			hash = HashValue(hash, config.FontBuilderFlags);
+			hash = HashValue(hash, config.RasterizerMultiply);
+			hash = HashValue(hash, config.EllipsisChar);
+			hash = HashValue(hash, GetFontIndex(atlas, config.DstFont));
+
+			// ranges are pairs of codepoints terminated by a zero
+			std::size_t rangeSize = 0;
+			if (const ImWchar* ranges = config.GlyphRanges)
+			{
+				while (ranges[rangeSize] != 0)
+					rangeSize++;
+
+				hash = ImguiFingerprint::Compute(ranges, rangeSize * sizeof(ImWchar), hash);
+			}
+			hash = HashValue(hash, UInt64(rangeSize));
+		}
+
+		// custom rects added by the user before the build are packed with the glyphs
+		hash = HashValue(hash, atlas.CustomRects.Size);
+		for (const ImFontAtlasCustomRect& rect : atlas.CustomRects)
+		{
+			hash = HashValue(hash, rect.Width);
+			hash = HashValue(hash, rect.Height);
+			hash = HashValue(hash, rect.GlyphID);
+			hash = HashValue(hash, rect.GlyphAdvanceX);
+			hash = HashValue(hash, rect.GlyphOffset);
+			hash = HashValue(hash, GetFontIndex(atlas, rect.Font));
+		}
+
+		return hash;
+	}
+
+	bool Load(const std::filesystem::path& filePath, ImFontAtlas& atlas, UInt64 key, unsigned int bytesPerPixel)
+	{
+		std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+		if (!file)
+			return false;
+
+		std::streamoff fileSize = file.tellg();
+		if (fileSize <= 0)
+			return false;
+
+		std::vector<UInt8> content(static_cast<std::size_t>(fileSize));
+		file.seekg(0);
+		if (!file.read(reinterpret_cast<char*>(content.data()), fileSize))
+			return false;
+
+		// everything is read and checked before the atlas is touched, so a stale or truncated file leaves it unbuilt
+		CacheReader reader(content);
+
+		UInt32 magic, version;
+		UInt64 cacheKey;
+		if (!reader.Read(magic) || !reader.Read(version) || !reader.Read(cacheKey))
+			return false;
+
+		if (magic != CacheMagic || version != CacheVersion || cacheKey != key)
+			return false;
+
+		int texWidth, texHeight;
+		UInt8 texPixelsUseColors;
+		ImVec2 texUvWhitePixel;
+		ImVec4 texUvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+		int packIdMouseCursors, packIdLines;
+		if (!reader.Read(texWidth) || !reader.Read(texHeight) || !reader.Read(texPixelsUseColors) || !reader.Read(texUvWhitePixel) ||
+		    !reader.Read(texUvLines) || !reader.Read(packIdMouseCursors) || !reader.Read(packIdLines))
+			return false;
+
+		if (texWidth <= 0 || texHeight <= 0)
+			return false;
+
+		UInt32 customRectCount;
+		if (!reader.Read(customRectCount))
+			return false;
+
+		std::vector<CachedCustomRect> customRects(customRectCount);
+		for (CachedCustomRect& rect : customRects)
+		{
+			if (!reader.Read(rect) || rect.fontIndex >= atlas.Fonts.Size)
+				return false;
+		}
+
+		UInt32 fontCount;
+		if (!reader.Read(fontCount) || fontCount != UInt32(atlas.Fonts.Size))
+			return false;
+
+		std::vector<CachedFont> fonts(fontCount);
+		for (CachedFont& font : fonts)
+		{
+			UInt32 glyphCount;
+			if (!reader.Read(font.fontSize) || !reader.Read(font.ascent) || !reader.Read(font.descent) || !reader.Read(font.metricsTotalSurface) ||
+			    !reader.Read(font.fallbackChar) || !reader.Read(font.ellipsisChar) || !reader.Read(glyphCount))
+				return false;
+
+			if (glyphCount > reader.GetRemaining() / sizeof(ImFontGlyph))
+				return false;
+
+			font.glyphs.resize(glyphCount);
+			if (!reader.ReadBytes(font.glyphs.data(), glyphCount * sizeof(ImFontGlyph)))
+				return false;
+		}
+
+		std::size_t pixelSize = std::size_t(texWidth) * std::size_t(texHeight) * bytesPerPixel;
+		if (reader.GetRemaining() != pixelSize)
+			return false;
+
+		unsigned char* pixels = static_cast<unsigned char*>(IM_ALLOC(pixelSize));
+		reader.ReadBytes(pixels, pixelSize);
+
+		// restore what ImFontAtlas::Build would have left, without rasterizing anything
+		atlas.ClearTexData();
+		if (bytesPerPixel == 1)
+			atlas.TexPixelsAlpha8 = pixels;
+		else
+			atlas.TexPixelsRGBA32 = reinterpret_cast<unsigned int*>(pixels);
+
+		atlas.TexWidth = texWidth;
+		atlas.TexHeight = texHeight;
+		atlas.TexUvScale = ImVec2(1.f / texWidth, 1.f / texHeight);
+		atlas.TexUvWhitePixel = texUvWhitePixel;
+		std::memcpy(atlas.TexUvLines, texUvLines, sizeof(texUvLines));
+		atlas.TexPixelsUseColors = texPixelsUseColors != 0;
+		atlas.PackIdMouseCursors = packIdMouseCursors;
+		atlas.PackIdLines = packIdLines;
+
+		atlas.CustomRects.resize(int(customRects.size()));
+		for (std::size_t i = 0; i < customRects.size(); ++i)
+		{
+			const CachedCustomRect& cachedRect = customRects[i];
+
+			ImFontAtlasCustomRect& rect = atlas.CustomRects[int(i)];
+			rect.Width = cachedRect.width;
+			rect.Height = cachedRect.height;
+			rect.X = cachedRect.x;
+			rect.Y = cachedRect.y;
+			rect.GlyphID = cachedRect.glyphId;
+			rect.GlyphAdvanceX = cachedRect.glyphAdvanceX;
+			rect.GlyphOffset = cachedRect.glyphOffset;
+			rect.Font = (cachedRect.fontIndex >= 0) ? atlas.Fonts[cachedRect.fontIndex] : nullptr;
+		}
+
+		for (int i = 0; i < atlas.Fonts.Size; ++i)
+		{
+			const CachedFont& cachedFont = fonts[std::size_t(i)];
+
+			ImFont* font = atlas.Fonts[i];
+			font->ClearOutputData();
+			font->ContainerAtlas = &atlas;
+			font->FontSize = cachedFont.fontSize;
+			font->Ascent = cachedFont.ascent;
+			font->Descent = cachedFont.descent;
+			font->MetricsTotalSurface = cachedFont.metricsTotalSurface;
+			font->FallbackChar = cachedFont.fallbackChar;
+			font->EllipsisChar = cachedFont.ellipsisChar;
+
+			font->ConfigData = nullptr;
+			font->ConfigDataCount = 0;
+			for (const ImFontConfig& config : atlas.ConfigData)
+			{
+				if (config.DstFont != font)
+					continue;
+
+				if (!font->ConfigData)
+					font->ConfigData = &config;
+
+				font->ConfigDataCount++;
+			}
+
+			font->Glyphs.resize(int(cachedFont.glyphs.size()));
+			if (!cachedFont.glyphs.empty())
+				std::memcpy(font->Glyphs.Data, cachedFont.glyphs.data(), cachedFont.glyphs.size() * sizeof(ImFontGlyph));
+
+			font->BuildLookupTable();
+		}
+
+		atlas.TexReady = true;
+
+		return true;
+	}
+
+	bool Save(const std::filesystem::path& filePath, const ImFontAtlas& atlas, UInt64 key, unsigned int bytesPerPixel)
+	{
+		const unsigned char* pixels = (bytesPerPixel == 1) ? atlas.TexPixelsAlpha8 : reinterpret_cast<const unsigned char*>(atlas.TexPixelsRGBA32);
+		if (!pixels || atlas.TexWidth <= 0 || atlas.TexHeight <= 0)
+			return false;
+
+		CacheWriter writer;
+		writer.Write(CacheMagic);
+		writer.Write(CacheVersion);
+		writer.Write(key);
+
+		writer.Write(atlas.TexWidth);
+		writer.Write(atlas.TexHeight);
+		writer.Write(UInt8(atlas.TexPixelsUseColors));
+		writer.Write(atlas.TexUvWhitePixel);
+		writer.Write(atlas.TexUvLines);
+		writer.Write(atlas.PackIdMouseCursors);
+		writer.Write(atlas.PackIdLines);
+
+		writer.Write(UInt32(atlas.CustomRects.Size));
+		for (const ImFontAtlasCustomRect& rect : atlas.CustomRects)
+		{
+			CachedCustomRect cachedRect;
+			std::memset(&cachedRect, 0, sizeof(cachedRect)); // padding is written too
+			cachedRect.width = rect.Width;
+			cachedRect.height = rect.Height;
+			cachedRect.x = rect.X;
+			cachedRect.y = rect.Y;
+			cachedRect.glyphId = rect.GlyphID;
+			cachedRect.glyphAdvanceX = rect.GlyphAdvanceX;
+			cachedRect.glyphOffset = rect.GlyphOffset;
+			cachedRect.fontIndex = GetFontIndex(atlas, rect.Font);
+
+			writer.Write(cachedRect);
+		}
+
+		writer.Write(UInt32(atlas.Fonts.Size));
+		for (const ImFont* font : atlas.Fonts)
+		{
+			writer.Write(font->FontSize);
+			writer.Write(font->Ascent);
+			writer.Write(font->Descent);
+			writer.Write(font->MetricsTotalSurface);
+			writer.Write(font->FallbackChar);
+			writer.Write(font->EllipsisChar);
+			writer.Write(UInt32(font->Glyphs.Size));
+			writer.WriteBytes(font->Glyphs.Data, std::size_t(font->Glyphs.Size) * sizeof(ImFontGlyph));
+		}
+
+		writer.WriteBytes(pixels, std::size_t(atlas.TexWidth) * std::size_t(atlas.TexHeight) * bytesPerPixel);
+
+		// write next to the cache and rename it, so an interrupted write never leaves a truncated cache behind
+		std::error_code ec;
+		if (filePath.has_parent_path())
+			std::filesystem::create_directories(filePath.parent_path(), ec);
+
+		std::filesystem::path tempPath = filePath;
+		tempPath += ".tmp";
+
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file)
+				return false;
+
+			const std::vector<UInt8>& data = writer.GetData();
+			if (!file.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size())))
+				return false;
+		}
+
+		std::filesystem::rename(tempPath, filePath, ec);
+		return !ec;
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Nazara/Prerequisites.hpp>
+
+#include <imgui.h>
+
+#include <filesystem>
+
+/*
+	ImguiFontAtlasCache.hpp
+	Saves a built font atlas (pixels, glyphs and metrics) to a file, so the next start can skip rasterizing it
+*/
+
+namespace Nz::ImguiFontAtlasCache
+{
+	// Identifies the atlas the fonts added to this atlas would build: font data, configs, custom rects and pixel format
+	UInt64 ComputeKey(const ImFontAtlas& atlas, unsigned int bytesPerPixel);
+
+	// Restores an atlas whose fonts were added but not built yet, returns false if the file is missing or was built for another key
+	bool Load(const std::filesystem::path& filePath, ImFontAtlas& atlas, UInt64 key, unsigned int bytesPerPixel);
+	bool Save(const std::filesystem::path& filePath, const ImFontAtlas& atlas, UInt64 key, unsigned int bytesPerPixel);
+}
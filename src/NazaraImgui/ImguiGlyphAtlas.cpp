@@ -0,0 +1,302 @@
+#include <NazaraImgui/ImguiGlyphAtlas.hpp>
+
+#include <imgui_internal.h>
+
+#include <algorithm>
+#include <cmath>
+
+// imgui compiles its own copy static too, glyphs are rasterized the same way it does when building the atlas
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4505)
+#endif
+
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <imstb_truetype.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+namespace Nz
+{
+	namespace
+	{
+		struct GlyphSource
+		{
+			const ImFontConfig* config;
+			stbtt_fontinfo fontInfo;
+			float scale;
+		};
+	}
+
+	bool ImguiGlyphAtlas::AddGlyphs(ImFontAtlas& atlas, ImFont& font, std::vector<ImWchar> codepoints)
+	{
+		std::sort(codepoints.begin(), codepoints.end());
+		codepoints.erase(std::unique(codepoints.begin(), codepoints.end()), codepoints.end());
+
+		std::vector<ImWchar>& addedCodepoints = m_addedCodepoints[&font];
+
+		// the atlas isn't built, it will be with the added glyphs
+		bool fits = (atlas.TexPixelsAlpha8 != nullptr);
+
+		// configs merged into the font are looked up in order, like imgui does when building
+		std::vector<GlyphSource> sources;
+		for (const ImFontConfig& config : atlas.ConfigData)
+		{
+			if (config.DstFont != &font || !config.FontData)
+				continue;
+
+			const unsigned char* fontData = static_cast<const unsigned char*>(config.FontData);
+			int fontOffset = stbtt_GetFontOffsetForIndex(fontData, config.FontNo);
+
+			GlyphSource source;
+			source.config = &config;
+			if (fontOffset < 0 || !stbtt_InitFont(&source.fontInfo, fontData, fontOffset))
+				continue;
+
+			source.scale = (config.SizePixels > 0.f) ? stbtt_ScaleForPixelHeight(&source.fontInfo, config.SizePixels) : stbtt_ScaleForMappingEmToPixels(&source.fontInfo, -config.SizePixels);
+			sources.push_back(source);
+		}
+
+		bool glyphAdded = false;
+		for (ImWchar codepoint : codepoints)
+		{
+			if (font.FindGlyphNoFallback(codepoint))
+				continue;
+
+			auto it = std::lower_bound(addedCodepoints.begin(), addedCodepoints.end(), codepoint);
+			if (it == addedCodepoints.end() || *it != codepoint)
+				addedCodepoints.insert(it, codepoint);
+
+			if (!fits)
+				continue;
+
+			for (const GlyphSource& source : sources)
+			{
+				int glyphIndex = stbtt_FindGlyphIndex(&source.fontInfo, codepoint);
+				if (glyphIndex == 0)
+					continue;
+
+				const ImFontConfig& config = *source.config;
+				int oversampleH = std::clamp(config.OversampleH, 1, STBTT_MAX_OVERSAMPLE);
+				int oversampleV = std::clamp(config.OversampleV, 1, STBTT_MAX_OVERSAMPLE);
+				float scaleX = source.scale * oversampleH;
+				float scaleY = source.scale * oversampleV;
+
+				int boxX0, boxY0, boxX1, boxY1;
+				stbtt_GetGlyphBitmapBoxSubpixel(&source.fontInfo, glyphIndex, scaleX, scaleY, 0.f, 0.f, &boxX0, &boxY0, &boxX1, &boxY1);
+
+				int advance, leftSideBearing;
+				stbtt_GetGlyphHMetrics(&source.fontInfo, glyphIndex, &advance, &leftSideBearing);
+				float advanceX = advance * source.scale;
+
+				// glyphs without pixels (spaces) only have an advance
+				if (boxX1 <= boxX0 || boxY1 <= boxY0)
+				{
+					font.AddGlyph(&config, codepoint, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, advanceX);
+					glyphAdded = true;
+					break;
+				}
+
+				// same size and filtering as stbtt_PackFontRanges, padding is kept on the right and bottom
+				int width = boxX1 - boxX0 + oversampleH - 1;
+				int height = boxY1 - boxY0 + oversampleV - 1;
+
+				int x, y;
+				if (!Allocate(width + atlas.TexGlyphPadding, height + atlas.TexGlyphPadding, x, y))
+				{
+					fits = false;
+					break;
+				}
+
+				int stride = atlas.TexWidth;
+				unsigned char* output = atlas.TexPixelsAlpha8 + x + y * stride;
+				stbtt_MakeGlyphBitmapSubpixel(&source.fontInfo, output, width - oversampleH + 1, height - oversampleV + 1, stride, scaleX, scaleY, 0.f, 0.f, glyphIndex);
+
+				if (oversampleH > 1)
+					stbtt__h_prefilter(output, width, height, stride, oversampleH);
+
+				if (oversampleV > 1)
+					stbtt__v_prefilter(output, width, height, stride, oversampleV);
+
+				if (config.RasterizerMultiply != 1.f)
+				{
+					unsigned char multiplyTable[256];
+					ImFontAtlasBuildMultiplyCalcLookupTable(multiplyTable, config.RasterizerMultiply);
+					ImFontAtlasBuildMultiplyRectAlpha8(multiplyTable, atlas.TexPixelsAlpha8, x, y, width, height, stride);
+				}
+
+				// the rgba copy imgui converted from the alpha pixels has to match them
+				if (atlas.TexPixelsRGBA32)
+				{
+					for (int row = y; row < y + height; ++row)
+					{
+						for (int column = x; column < x + width; ++column)
+							atlas.TexPixelsRGBA32[column + row * stride] = IM_COL32(255, 255, 255, atlas.TexPixelsAlpha8[column + row * stride]);
+					}
+				}
+
+				// same metrics as imgui gives packed glyphs (see stbtt_GetPackedQuad and ImFontAtlasBuildWithStbTruetype)
+				float recipH = 1.f / oversampleH;
+				float recipV = 1.f / oversampleV;
+				float offsetX = config.GlyphOffset.x + stbtt__oversample_shift(oversampleH);
+				float offsetY = config.GlyphOffset.y + IM_ROUND(font.Ascent) + stbtt__oversample_shift(oversampleV);
+
+				float texelU = 1.f / atlas.TexWidth;
+				float texelV = 1.f / atlas.TexHeight;
+
+				font.AddGlyph(&config, codepoint,
+					boxX0 * recipH + offsetX, boxY0 * recipV + offsetY, (boxX0 + width) * recipH + offsetX, (boxY0 + height) * recipV + offsetY,
+					x * texelU, y * texelV, (x + width) * texelU, (y + height) * texelV, advanceX);
+
+				glyphAdded = true;
+				break;
+			}
+		}
+
+		if (glyphAdded)
+			font.BuildLookupTable();
+
+		return fits;
+	}
+
+	bool ImguiGlyphAtlas::IsRequested(const ImFont& font, ImWchar codepoint) const
+	{
+		auto it = m_addedCodepoints.find(&font);
+		if (it == m_addedCodepoints.end())
+			return false;
+
+		return std::binary_search(it->second.begin(), it->second.end(), codepoint);
+	}
+
+	void ImguiGlyphAtlas::ExtendGlyphRanges(ImFontAtlas& atlas)
+	{
+		std::size_t configCount = std::size_t(atlas.ConfigData.Size);
+		m_glyphRanges.resize(configCount);
+		m_originalGlyphRanges.resize(configCount, nullptr);
+
+		for (std::size_t i = 0; i < configCount; ++i)
+		{
+			ImFontConfig& config = atlas.ConfigData[int(i)];
+
+			auto it = m_addedCodepoints.find(config.DstFont);
+			if (it == m_addedCodepoints.end() || it->second.empty())
+				continue;
+
+			// the ranges the application gave, unless these are the ones extended last time
+			if (m_glyphRanges[i].empty() || config.GlyphRanges != m_glyphRanges[i].data())
+				m_originalGlyphRanges[i] = (config.GlyphRanges) ? config.GlyphRanges : atlas.GetGlyphRangesDefault();
+
+			std::vector<ImWchar> glyphRanges;
+			for (const ImWchar* range = m_originalGlyphRanges[i]; range[0] != 0; range += 2)
+			{
+				glyphRanges.push_back(range[0]);
+				glyphRanges.push_back(range[1]);
+			}
+
+			// building skips codepoints the font doesn't have, and the ones a previous config of the same font already added
+			for (ImWchar codepoint : it->second)
+			{
+				glyphRanges.push_back(codepoint);
+				glyphRanges.push_back(codepoint);
+			}
+			glyphRanges.push_back(0);
+
+			m_glyphRanges[i] = std::move(glyphRanges);
+			config.GlyphRanges = m_glyphRanges[i].data();
+		}
+	}
+
+	void ImguiGlyphAtlas::ReserveSpace(ImFontAtlas& atlas, int width, int height)
+	{
+		// custom rects are kept when the atlas is built again, it's only added once
+		if (m_reservedRectId >= 0 && m_reservedRectId < atlas.CustomRects.Size)
+		{
+			const ImFontAtlasCustomRect& rect = atlas.CustomRects[m_reservedRectId];
+			if (rect.Width == width && rect.Height == height)
+				return;
+		}
+
+		m_reservedRectId = (width > 0 && height > 0) ? atlas.AddCustomRectRegular(width, height) : -1;
+	}
+
+	void ImguiGlyphAtlas::Reset(const ImFontAtlas& atlas)
+	{
+		m_regions.clear();
+
+		int usedHeight = 0;
+		for (const ImFont* font : atlas.Fonts)
+		{
+			for (const ImFontGlyph& glyph : font->Glyphs)
+				usedHeight = std::max(usedHeight, int(std::ceil(glyph.V1 * atlas.TexHeight)));
+		}
+
+		for (int i = 0; i < atlas.CustomRects.Size; ++i)
+		{
+			const ImFontAtlasCustomRect& rect = atlas.CustomRects[i];
+			if (!rect.IsPacked())
+				continue;
+
+			if (i == m_reservedRectId)
+			{
+				Region& region = m_regions.emplace_back();
+				region.x = rect.X;
+				region.y = rect.Y;
+				region.width = rect.Width;
+				region.height = rect.Height;
+			}
+
+			usedHeight = std::max(usedHeight, rect.Y + rect.Height);
+		}
+
+		// the atlas height is rounded to a power of two, what's below the packed rects is free too
+		int top = usedHeight + atlas.TexGlyphPadding;
+		if (top < atlas.TexHeight)
+		{
+			Region& region = m_regions.emplace_back();
+			region.x = 0;
+			region.y = top;
+			region.width = atlas.TexWidth;
+			region.height = atlas.TexHeight - top;
+		}
+	}
+
+	bool ImguiGlyphAtlas::Allocate(int width, int height, int& x, int& y)
+	{
+		for (Region& region : m_regions)
+		{
+			if (width > region.width)
+				continue;
+
+			int shelfX = region.shelfX;
+			int shelfY = region.shelfY;
+			int shelfHeight = region.shelfHeight;
+			if (shelfX + width > region.width)
+			{
+				shelfY += shelfHeight;
+				shelfX = 0;
+				shelfHeight = 0;
+			}
+
+			if (shelfY + height > region.height)
+				continue;
+
+			x = region.x + shelfX;
+			y = region.y + shelfY;
+
+			region.shelfX = shelfX + width;
+			region.shelfY = shelfY;
+			region.shelfHeight = std::max(shelfHeight, height);
+			return true;
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Nazara/Prerequisites.hpp>
+
+#include <imgui.h>
+
+#include <unordered_map>
+#include <vector>
+
+/*
+	ImguiGlyphAtlas.hpp
+	Rasterizes glyphs into the free space of a built font atlas, so adding glyphs doesn't build the whole atlas again
+*/
+
+namespace Nz
+{
+	class ImguiGlyphAtlas
+	{
+	public:
+		ImguiGlyphAtlas() = default;
+
+		// Rasterizes the codepoints the font misses into the atlas pixels (alpha and rgba if built), returns false once the free space is full
+		// Codepoints are remembered even when they don't fit, ExtendGlyphRanges makes the next build include them
+		bool AddGlyphs(ImFontAtlas& atlas, ImFont& font, std::vector<ImWchar> codepoints);
+
+		// Whether the codepoint was given to AddGlyphs for this font, even if the font doesn't have it
+		bool IsRequested(const ImFont& font, ImWchar codepoint) const;
+
+		// Adds the glyphs added so far to the glyph ranges of their fonts, call it before the atlas is built again
+		void ExtendGlyphRanges(ImFontAtlas& atlas);
+
+		// Keeps a rect of the atlas free for added glyphs, call it before the atlas is built
+		void ReserveSpace(ImFontAtlas& atlas, int width, int height);
+
+		// Finds the free space of a freshly built atlas: the reserved rect and what's left below the packed glyphs
+		void Reset(const ImFontAtlas& atlas);
+
+	private:
+		// Free space filled with shelves, left to right then top to bottom
+		struct Region
+		{
+			int x;
+			int y;
+			int width;
+			int height;
+			int shelfX = 0;
+			int shelfY = 0;
+			int shelfHeight = 0;
+		};
+
+		bool Allocate(int width, int height, int& x, int& y);
+
+		// sorted codepoints given to AddGlyphs for each font
+		std::unordered_map<const ImFont*, std::vector<ImWchar>> m_addedCodepoints;
+		// glyph ranges given to each font config, and the ones the application set
+		std::vector<std::vector<ImWchar>> m_glyphRanges;
+		std::vector<const ImWchar*> m_originalGlyphRanges;
+		std::vector<Region> m_regions;
+		int m_reservedRectId = -1;
+	};
+}
@@ -0,0 +1,179 @@
+#include <NazaraImgui/ImguiHandlerCache.hpp>
+
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include <imgui_internal.h>
+
+#include <cstring>
+
+namespace Nz
+{
+	namespace
+	{
+		template<typename T>
+		void CopyVector(ImVector<T>& destination, const ImVector<T>& source)
+		{
+			// ImVector assignment frees its storage first, resizing keeps it
+			destination.resize(source.Size);
+			if (source.Size > 0)
+				std::memcpy(destination.Data, source.Data, source.Size * sizeof(T));
+		}
+
+		// children are drawn right after their parent, appending them keeps the same order
+		void AppendDrawList(const ImDrawList& drawList, ImVector<ImDrawCmd>& commands, ImVector<ImDrawVert>& vertices, ImVector<ImDrawIdx>& indices)
+		{
+			unsigned int vertexOffset = static_cast<unsigned int>(vertices.Size);
+			unsigned int indexOffset = static_cast<unsigned int>(indices.Size);
+
+			for (const ImDrawCmd& cmd : drawList.CmdBuffer)
+			{
+				if (cmd.UserCallback || cmd.ElemCount == 0)
+					continue;
+
+				commands.push_back(cmd);
+
+				ImDrawCmd& command = commands.back();
+				command.VtxOffset += vertexOffset;
+				command.IdxOffset += indexOffset;
+			}
+
+			int vertexCount = vertices.Size;
+			vertices.resize(vertexCount + drawList.VtxBuffer.Size);
+			if (drawList.VtxBuffer.Size > 0)
+				std::memcpy(vertices.Data + vertexCount, drawList.VtxBuffer.Data, drawList.VtxBuffer.Size * sizeof(ImDrawVert));
+
+			int indexCount = indices.Size;
+			indices.resize(indexCount + drawList.IdxBuffer.Size);
+			if (drawList.IdxBuffer.Size > 0)
+				std::memcpy(indices.Data + indexCount, drawList.IdxBuffer.Data, drawList.IdxBuffer.Size * sizeof(ImDrawIdx));
+		}
+
+		void AppendWindow(const ImGuiWindow& window, ImVector<ImDrawCmd>& commands, ImVector<ImDrawVert>& vertices, ImVector<ImDrawIdx>& indices)
+		{
+			AppendDrawList(*window.DrawList, commands, vertices, indices);
+
+			for (const ImGuiWindow* child : window.DC.ChildWindows)
+			{
+				if (child->Active && !child->Hidden)
+					AppendWindow(*child, commands, vertices, indices);
+			}
+		}
+	}
+
+	void ImguiHandlerCache::BeginCapture()
+	{
+		m_firstBeginOrder = ImGui::GetCurrentContext()->WindowsActiveCount;
+	}
+
+	void ImguiHandlerCache::EndCapture()
+	{
+		ImGuiContext& context = *ImGui::GetCurrentContext();
+
+		std::size_t windowCount = 0;
+		m_replayable = true;
+		for (ImGuiWindow* window : context.Windows)
+		{
+			if (window->LastFrameActive != context.FrameCount || window->BeginOrderWithinContext < m_firstBeginOrder)
+				continue;
+
+			// children are part of their parent's content
+			if (window->Flags & ImGuiWindowFlags_ChildWindow)
+				continue;
+
+			// popups and tooltips only live while interacting, docked windows are drawn by their host
+			if ((window->Flags & (ImGuiWindowFlags_Popup | ImGuiWindowFlags_Tooltip)) || window->DockIsActive)
+			{
+				m_replayable = false;
+				break;
+			}
+
+			if (windowCount >= m_windows.size())
+				m_windows.emplace_back();
+
+			CachedWindow& cachedWindow = m_windows[windowCount++];
+			cachedWindow.id = window->ID;
+			cachedWindow.name = window->Name;
+			cachedWindow.flags = window->Flags;
+			cachedWindow.pos = window->Pos;
+			cachedWindow.size = window->Size;
+			cachedWindow.cursorMaxPos = window->DC.CursorMaxPos - window->Pos;
+			cachedWindow.idealMaxPos = window->DC.IdealMaxPos - window->Pos;
+			cachedWindow.collapsed = window->Collapsed;
+
+			cachedWindow.commands.resize(0);
+			cachedWindow.vertices.resize(0);
+			cachedWindow.indices.resize(0);
+			AppendWindow(*window, cachedWindow.commands, cachedWindow.vertices, cachedWindow.indices);
+		}
+
+		m_windows.resize(windowCount);
+		if (m_windows.empty())
+			m_replayable = false;
+	}
+
+	void ImguiHandlerCache::Clear()
+	{
+		m_windows.clear();
+		m_replayable = false;
+	}
+
+	bool ImguiHandlerCache::IsReplayable() const
+	{
+		if (!m_replayable)
+			return false;
+
+		const ImGuiContext& context = *ImGui::GetCurrentContext();
+		auto isRootOf = [](const ImGuiWindow* window, const ImGuiWindow* root) { return window && window->RootWindow == root; };
+
+		for (const CachedWindow& cachedWindow : m_windows)
+		{
+			ImGuiWindow* window = ImGui::FindWindowByID(cachedWindow.id);
+			if (!window || window->Collapsed != cachedWindow.collapsed || window->Size.x != cachedWindow.size.x || window->Size.y != cachedWindow.size.y)
+				return false;
+
+			if (isRootOf(context.HoveredWindow, window) || isRootOf(context.NavWindow, window) || isRootOf(context.ActiveIdWindow, window) || isRootOf(context.MovingWindow, window))
+				return false;
+		}
+
+		return true;
+	}
+
+	void ImguiHandlerCache::Replay()
+	{
+		for (const CachedWindow& cachedWindow : m_windows)
+		{
+			// Begin/End keep the window alive (position, z-order, focus), its content is then replaced by the cached one
+			ImGui::Begin(cachedWindow.name.c_str(), nullptr, cachedWindow.flags);
+			ImGui::End();
+
+			ImGuiWindow* window = ImGui::FindWindowByID(cachedWindow.id);
+			ImDrawList& drawList = *window->DrawList;
+
+			CopyVector(drawList.CmdBuffer, cachedWindow.commands);
+			CopyVector(drawList.VtxBuffer, cachedWindow.vertices);
+			CopyVector(drawList.IdxBuffer, cachedWindow.indices);
+
+			ImVec2 offset = window->Pos - cachedWindow.pos;
+			if (offset.x != 0.f || offset.y != 0.f)
+			{
+				for (ImDrawVert& vertex : drawList.VtxBuffer)
+					vertex.pos += offset;
+
+				for (ImDrawCmd& command : drawList.CmdBuffer)
+				{
+					command.ClipRect.x += offset.x;
+					command.ClipRect.y += offset.y;
+					command.ClipRect.z += offset.x;
+					command.ClipRect.w += offset.y;
+				}
+			}
+
+			// imgui checks its write cursors when adding the list to the draw data
+			drawList._VtxWritePtr = drawList.VtxBuffer.Data + drawList.VtxBuffer.Size;
+			drawList._IdxWritePtr = drawList.IdxBuffer.Data + drawList.IdxBuffer.Size;
+			drawList._VtxCurrentIdx = static_cast<unsigned int>(drawList.VtxBuffer.Size) - ((drawList.CmdBuffer.Size > 0) ? drawList.CmdBuffer.back().VtxOffset : 0);
+
+			window->DC.CursorMaxPos = window->Pos + cachedWindow.cursorMaxPos;
+			window->DC.IdealMaxPos = window->Pos + cachedWindow.idealMaxPos;
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Nazara/Prerequisites.hpp>
+
+#include <imgui.h>
+
+#include <string>
+#include <vector>
+
+/*
+	ImguiHandlerCache.hpp
+	Keeps what the windows of a handler drew, so they can be submitted again without running the handler
+*/
+
+namespace Nz
+{
+	class ImguiHandlerCache
+	{
+	public:
+		ImguiHandlerCache() = default;
+		ImguiHandlerCache(const ImguiHandlerCache&) = delete;
+		ImguiHandlerCache(ImguiHandlerCache&&) = delete;
+		~ImguiHandlerCache() = default;
+
+		ImguiHandlerCache& operator=(const ImguiHandlerCache&) = delete;
+		ImguiHandlerCache& operator=(ImguiHandlerCache&&) = delete;
+
+		// Windows begun between these two calls are the handler's, their draw lists (children included) are copied by EndCapture
+		void BeginCapture();
+		void EndCapture();
+
+		void Clear();
+
+		// False when nothing was captured, or when a window was resized, collapsed or is being interacted with and needs live widgets
+		bool IsReplayable() const;
+		// Submits the captured windows again with their cached content, moved along with the windows
+		void Replay();
+
+	private:
+		struct CachedWindow
+		{
+			ImGuiID id;
+			std::string name;
+			ImGuiWindowFlags flags;
+			ImVec2 pos;
+			ImVec2 size;
+			// relative to the window position, restored so the next live frame sizes the window from them
+			ImVec2 cursorMaxPos;
+			ImVec2 idealMaxPos;
+			bool collapsed;
+			ImVector<ImDrawCmd> commands;
+			ImVector<ImDrawVert> vertices;
+			ImVector<ImDrawIdx> indices;
+		};
+
+		std::vector<CachedWindow> m_windows;
+		int m_firstBeginOrder = 0;
+		bool m_replayable = false;
+	};
+}
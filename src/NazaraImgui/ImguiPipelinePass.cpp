@@ -7,16 +7,21 @@
 
 namespace Nz
 {
-	ImguiPipelinePass::ImguiPipelinePass(PassData& /*passData*/, std::string passName, const ParameterList& /*parameters*/) :
+	ImguiPipelinePass::ImguiPipelinePass(PassData& /*passData*/, std::string passName, const ParameterList& parameters) :
 		FramePipelinePass({})
 		, m_passName(std::move(passName))
+		, m_cachedLayer(parameters.GetBooleanParameter("CachedLayer").GetValueOr(false))
 	{
 	}
 
 	void ImguiPipelinePass::Prepare(FrameData& frameData)
 	{
+		Nz::Imgui::Instance()->PrepareDrawer(frameData.renderResources);
+
 		ImguiDrawer& imguiDrawer = Nz::Imgui::Instance()->GetImguiDrawer();
-		imguiDrawer.Prepare(frameData.renderResources);
+
+		if (m_cachedLayer)
+			imguiDrawer.RenderLayer(frameData.renderResources);
 	}
 
 	FramePass& ImguiPipelinePass::RegisterToFrameGraph(FrameGraph& frameGraph, const PassInputOuputs& inputOuputs)
@@ -33,13 +38,18 @@ namespace Nz
 
 		imguiPass.SetExecutionCallback([&]
 			{
-				return FramePassExecution::UpdateAndExecute;
+				// unchanged draw data reuses the commands recorded for it, along with the buffers and bindings they reference
+				ImguiDrawer& imguiDrawer = Nz::Imgui::Instance()->GetImguiDrawer();
+				return (imguiDrawer.HasFrameChanged()) ? FramePassExecution::UpdateAndExecute : FramePassExecution::Execute;
 			});
 
 		imguiPass.SetCommandCallback([this](CommandBufferBuilder& builder, const FramePassEnvironment& /*env*/)
 			{
 				ImguiDrawer& imguiDrawer = Nz::Imgui::Instance()->GetImguiDrawer();
-				imguiDrawer.Draw(builder);
+				if (m_cachedLayer)
+					imguiDrawer.DrawLayer(builder);
+				else
+					imguiDrawer.Draw(builder);
 			});
 
 		return imguiPass;
@@ -1,10 +1,15 @@
 #include <NazaraImgui/NazaraImgui.hpp>
 #include <NazaraImgui/ImguiPipelinePass.hpp>
 #include <NazaraImgui/ImguiDrawer.hpp>
+#include <NazaraImgui/ImguiFingerprint.hpp>
+#include <NazaraImgui/ImguiFontAtlasCache.hpp>
+#include <NazaraImgui/ImguiGlyphAtlas.hpp>
 #include <NazaraImgui/ImguiHandler.hpp>
+#include <NazaraImgui/ImguiHandlerCache.hpp>
 #include <NazaraImgui/ImguiWidgets.hpp>
 
 #include <Nazara/Core/DynLib.hpp>
+#include <Nazara/Core/Error.hpp>
 #include <Nazara/Core/Log.hpp>
 #include <Nazara/Graphics/RenderTarget.hpp>
 #include <Nazara/Platform/Cursor.hpp>
@@ -13,14 +18,23 @@
 #include <Nazara/Renderer/CommandBufferBuilder.hpp>
 #include <Nazara/Renderer/Renderer.hpp>
 #include <Nazara/Renderer/Texture.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
 #include <NZSL/Parser.hpp>
 
+#include <imgui_internal.h>
+
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cfloat>   // FLT_MAX
 #include <cmath>    // abs
 #include <cstddef>  // offsetof, NULL
 #include <cstring>  // memcpy
 #include <iostream>
 #include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 #if __cplusplus >= 201103L  // C++11 and above
 static_assert(sizeof(void*) <= sizeof(ImTextureID),
@@ -41,6 +55,107 @@ static_assert(sizeof(void*) <= sizeof(ImTextureID),
 
 namespace
 {
+    // imgui orders buttons left, right, middle
+    inline int ToImGui(Nz::Mouse::Button button)
+    {
+        switch (button)
+        {
+        case Nz::Mouse::Button::Left: return ImGuiMouseButton_Left;
+        case Nz::Mouse::Button::Right: return ImGuiMouseButton_Right;
+        case Nz::Mouse::Button::Middle: return ImGuiMouseButton_Middle;
+        case Nz::Mouse::Button::XButton1: return 3;
+        case Nz::Mouse::Button::XButton2: return 4;
+        default:
+            return -1;
+        }
+    }
+
+    inline ImGuiKey ToImGui(Nz::Keyboard::Scancode scancode)
+    {
+        using Scancode = Nz::Keyboard::Scancode;
+
+        if (scancode >= Scancode::A && scancode <= Scancode::Z)
+            return static_cast<ImGuiKey>(ImGuiKey_A + (int(scancode) - int(Scancode::A)));
+
+        if (scancode >= Scancode::Num0 && scancode <= Scancode::Num9)
+            return static_cast<ImGuiKey>(ImGuiKey_0 + (int(scancode) - int(Scancode::Num0)));
+
+        if (scancode >= Scancode::F1 && scancode <= Scancode::F12)
+            return static_cast<ImGuiKey>(ImGuiKey_F1 + (int(scancode) - int(Scancode::F1)));
+
+        if (scancode >= Scancode::Numpad0 && scancode <= Scancode::Numpad9)
+            return static_cast<ImGuiKey>(ImGuiKey_Keypad0 + (int(scancode) - int(Scancode::Numpad0)));
+
+        switch (scancode)
+        {
+        case Scancode::Tab: return ImGuiKey_Tab;
+        case Scancode::Left: return ImGuiKey_LeftArrow;
+        case Scancode::Right: return ImGuiKey_RightArrow;
+        case Scancode::Up: return ImGuiKey_UpArrow;
+        case Scancode::Down: return ImGuiKey_DownArrow;
+        case Scancode::PageUp: return ImGuiKey_PageUp;
+        case Scancode::PageDown: return ImGuiKey_PageDown;
+        case Scancode::Home: return ImGuiKey_Home;
+        case Scancode::End: return ImGuiKey_End;
+        case Scancode::Insert: return ImGuiKey_Insert;
+        case Scancode::Delete: return ImGuiKey_Delete;
+        case Scancode::Backspace: return ImGuiKey_Backspace;
+        case Scancode::Space: return ImGuiKey_Space;
+        case Scancode::Return: return ImGuiKey_Enter;
+        case Scancode::Escape: return ImGuiKey_Escape;
+        case Scancode::LControl: return ImGuiKey_LeftCtrl;
+        case Scancode::RControl: return ImGuiKey_RightCtrl;
+        case Scancode::LShift: return ImGuiKey_LeftShift;
+        case Scancode::RShift: return ImGuiKey_RightShift;
+        case Scancode::LAlt: return ImGuiKey_LeftAlt;
+        case Scancode::RAlt: return ImGuiKey_RightAlt;
+        case Scancode::LSystem: return ImGuiKey_LeftSuper;
+        case Scancode::RSystem: return ImGuiKey_RightSuper;
+        case Scancode::Menu: return ImGuiKey_Menu;
+        // keys named after their US layout character, as imgui does
+        case Scancode::Quote: return ImGuiKey_Apostrophe;
+        case Scancode::Comma: return ImGuiKey_Comma;
+        case Scancode::Dash: return ImGuiKey_Minus;
+        case Scancode::Period: return ImGuiKey_Period;
+        case Scancode::Slash: return ImGuiKey_Slash;
+        case Scancode::Semicolon: return ImGuiKey_Semicolon;
+        case Scancode::Equal: return ImGuiKey_Equal;
+        case Scancode::LBracket: return ImGuiKey_LeftBracket;
+        case Scancode::Backslash: return ImGuiKey_Backslash;
+        case Scancode::RBracket: return ImGuiKey_RightBracket;
+        case Scancode::Tilde: return ImGuiKey_GraveAccent;
+        case Scancode::CapsLock: return ImGuiKey_CapsLock;
+        case Scancode::ScrollLock: return ImGuiKey_ScrollLock;
+        case Scancode::NumLock: return ImGuiKey_NumLock;
+        case Scancode::PrintScreen: return ImGuiKey_PrintScreen;
+        case Scancode::Pause: return ImGuiKey_Pause;
+        // Nazara has no keypad equal key
+        case Scancode::Decimal: return ImGuiKey_KeypadDecimal;
+        case Scancode::Divide: return ImGuiKey_KeypadDivide;
+        case Scancode::Multiply: return ImGuiKey_KeypadMultiply;
+        case Scancode::Subtract: return ImGuiKey_KeypadSubtract;
+        case Scancode::Add: return ImGuiKey_KeypadAdd;
+        case Scancode::NumpadReturn: return ImGuiKey_KeypadEnter;
+        default:
+            return ImGuiKey_None;
+        }
+    }
+
+    inline ImGuiKeyModFlags ToImGuiModifier(Nz::Keyboard::Scancode scancode)
+    {
+        using Scancode = Nz::Keyboard::Scancode;
+
+        switch (scancode)
+        {
+        case Scancode::LControl: case Scancode::RControl: return ImGuiKeyModFlags_Ctrl;
+        case Scancode::LShift: case Scancode::RShift: return ImGuiKeyModFlags_Shift;
+        case Scancode::LAlt: case Scancode::RAlt: return ImGuiKeyModFlags_Alt;
+        case Scancode::LSystem: case Scancode::RSystem: return ImGuiKeyModFlags_Super;
+        default:
+            return ImGuiKeyModFlags_None;
+        }
+    }
+
     inline Nz::SystemCursor ToNz(ImGuiMouseCursor type)
     {
         switch (type)
@@ -65,22 +180,49 @@ namespace
 
 namespace Nz
 {
+    struct Imgui::ThrottledHandler
+    {
+        ImguiHandlerCache cache;
+        std::chrono::steady_clock::time_point nextRefresh;
+    };
+
     Imgui* Imgui::s_instance = nullptr;
 
-    Imgui::Imgui(Config /*config*/)
+    Imgui::Imgui(Config config)
         : ModuleBase("Imgui", this)
-        , m_bMouseMoved(false)
+        , m_keyModifiers(ImGuiKeyModFlags_None)
+        , m_lastInputLatency(std::chrono::nanoseconds::zero())
+        , m_bIdleMode(config.idleMode)
+        , m_bFrameSkipped(false)
+        , m_bRedrawRequested(true)
+        , m_skippedDeltaTime(0.f)
+        , m_idleSettleTime(config.idleSettleTime)
+        , m_idleKeepAlive(config.idleKeepAlive)
         , m_bWindowHasFocus(false)
+        , m_bSingleChannelFontAtlas(config.singleChannelFontAtlas)
+        , m_fontAtlasCachePath(std::move(config.fontAtlasCachePath))
+        , m_fontAtlasGlyphReserve(config.fontAtlasGlyphReserve)
         , m_currentContext(nullptr)
         , m_imguiDrawer(*Nz::Graphics::Instance()->GetRenderDevice())
+        , m_glyphAtlas(std::make_unique<ImguiGlyphAtlas>())
+        , m_bRunningHandlers(false)
+        , m_bSnapshotDrawData(config.snapshotDrawData)
+        , m_frontSnapshot(0)
+        , m_bDrawDataPending(false)
     {
         ImGui::CreateContext();
         ImGuiIO& io = ImGui::GetIO();
         io.UserData = this;
+
+        if (config.loadPipelinesInBackground)
+            m_imguiDrawer.LoadPipelinesAsync();
     }
 
     Imgui::~Imgui()
     {
+        // cached draw lists are freed through imgui's allocator
+        m_throttledHandlers.clear();
+
         ImGui::GetIO().Fonts->TexID = nullptr;
         ImGui::DestroyContext();
 
@@ -99,7 +241,9 @@ namespace Nz
         io.BackendFlags |= ImGuiBackendFlags_HasMouseCursors;
         io.BackendFlags |= ImGuiBackendFlags_HasSetMousePos;
         io.BackendFlags |= ImGuiBackendFlags_HasMouseHoveredViewport;
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
         io.BackendPlatformName = "imgui_nazara";
+        io.BackendRendererName = "imgui_nazara";
 
         // init rendering
         io.DisplaySize = ImVec2(window.GetSize().x * 1.f, window.GetSize().y * 1.f);
@@ -114,25 +258,47 @@ namespace Nz
 
         SetupInputs(window.GetEventHandler());
 
-        m_bWindowHasFocus = window.HasFocus();
+        {
+            std::lock_guard<std::mutex> lock(m_inputMutex);
+            m_bWindowHasFocus = window.HasFocus();
+        }
         m_window = &window;
+
+        // imgui would see the mouse nowhere until it moves (dropped if the window doesn't have focus)
+        Nz::Vector2i mousePosition = Nz::Mouse::GetPosition(window);
+
+        InputEvent inputEvent(InputEvent::Type::MousePos);
+        inputEvent.position = ImVec2(mousePosition.x * 1.f, mousePosition.y * 1.f);
+        PushInputEvent(inputEvent);
+
         return true;
     }
 
     void Imgui::Update(float dt)
     {
-        // Update OS/hardware mouse cursor if imgui isn't drawing a software cursor
-        UpdateMouseCursor(*m_window);
+        // the request is consumed when the frame starts, so one made by a handler while this frame renders wakes the next one
+        bool redrawRequested = m_bRedrawRequested.exchange(false);
 
-        if (m_bMouseMoved)
+        // an idle UI doesn't start a frame, Render then does nothing and the last frame is drawn again
+        m_bFrameSkipped = m_bIdleMode && !redrawRequested && !ShouldRunFrame(std::chrono::steady_clock::now());
+        if (m_bFrameSkipped)
         {
-            Update(Nz::Mouse::GetPosition(*m_window), m_window->GetSize(), dt);
-        }
-        else
-        {
-            Update({ 0,0 }, m_window->GetSize(), dt);
+            m_skippedDeltaTime += dt;
+            return;
         }
 
+        // imgui timers (double clicks, key repeat) see the time which passed while idle
+        dt += m_skippedDeltaTime;
+        m_skippedDeltaTime = 0.f;
+
+        // glyphs must be in the atlas before imgui locks it for the frame
+        ProcessPendingGlyphs();
+
+        // Update OS/hardware mouse cursor if imgui isn't drawing a software cursor
+        UpdateMouseCursor(*m_window);
+
+        Update(m_window->GetSize(), dt);
+
 #if UNFINISHED_WORK
         if (ImGui::GetIO().MouseDrawCursor) {
             // Hide OS mouse cursor if imgui is drawing it
@@ -141,135 +307,232 @@ namespace Nz
 #endif
     }
 
+    bool Imgui::ShouldRunFrame(std::chrono::steady_clock::time_point now)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_inputMutex);
+            if (now < m_activeUntil)
+                return true;
+        }
+
+        // text cursors blink and dragged widgets follow the mouse
+        const ImGuiIO& io = ImGui::GetIO();
+        if (io.WantTextInput || ImGui::IsAnyItemActive())
+            return true;
+
+        return now - m_lastFrameTime >= m_idleKeepAlive;
+    }
+
+    void Imgui::WakeUp()
+    {
+        std::lock_guard<std::mutex> lock(m_inputMutex);
+        KeepActiveUntil(std::chrono::steady_clock::now() + m_idleSettleTime);
+    }
+
+    void Imgui::KeepActiveUntil(std::chrono::steady_clock::time_point until)
+    {
+        // m_inputMutex has to be held, event handlers wake the UI up
+        m_activeUntil = std::max(m_activeUntil, until);
+    }
+
+    void Imgui::RequestRedraw()
+    {
+        m_bRedrawRequested = true;
+    }
+
+    void Imgui::RequestAnimation(std::chrono::nanoseconds duration)
+    {
+        auto until = std::chrono::steady_clock::now() + duration;
+
+        std::lock_guard<std::mutex> lock(m_inputMutex);
+        KeepActiveUntil(std::chrono::time_point_cast<std::chrono::steady_clock::duration>(until));
+    }
+
     void Imgui::SetupInputs(Nz::WindowEventHandler& handler)
     {
+        // events pushed within one frame are spread over the next ones by imgui, so a press and a release don't cancel each other
         ImGuiIO& io = ImGui::GetIO();
-
-        // init keyboard mapping
-        io.KeyMap[ImGuiKey_Tab] = (int)Nz::Keyboard::Scancode::Tab;
-        io.KeyMap[ImGuiKey_LeftArrow] = (int)Nz::Keyboard::Scancode::Left;
-        io.KeyMap[ImGuiKey_RightArrow] = (int)Nz::Keyboard::Scancode::Right;
-        io.KeyMap[ImGuiKey_UpArrow] = (int)Nz::Keyboard::Scancode::Up;
-        io.KeyMap[ImGuiKey_DownArrow] = (int)Nz::Keyboard::Scancode::Down;
-        io.KeyMap[ImGuiKey_PageUp] = (int)Nz::Keyboard::Scancode::PageUp;
-        io.KeyMap[ImGuiKey_PageDown] = (int)Nz::Keyboard::Scancode::PageDown;
-        io.KeyMap[ImGuiKey_Home] = (int)Nz::Keyboard::Scancode::Home;
-        io.KeyMap[ImGuiKey_End] = (int)Nz::Keyboard::Scancode::End;
-        io.KeyMap[ImGuiKey_Insert] = (int)Nz::Keyboard::Scancode::Insert;
-        io.KeyMap[ImGuiKey_Delete] = (int)Nz::Keyboard::Scancode::Delete;
-        io.KeyMap[ImGuiKey_Backspace] = (int)Nz::Keyboard::Scancode::Backspace;
-        io.KeyMap[ImGuiKey_Space] = (int)Nz::Keyboard::Scancode::Space;
-        io.KeyMap[ImGuiKey_Enter] = (int)Nz::Keyboard::Scancode::Return;
-        io.KeyMap[ImGuiKey_Escape] = (int)Nz::Keyboard::Scancode::Escape;
-        io.KeyMap[ImGuiKey_A] = (int)Nz::Keyboard::Scancode::A;
-        io.KeyMap[ImGuiKey_C] = (int)Nz::Keyboard::Scancode::C;
-        io.KeyMap[ImGuiKey_V] = (int)Nz::Keyboard::Scancode::V;
-        io.KeyMap[ImGuiKey_X] = (int)Nz::Keyboard::Scancode::X;
-        io.KeyMap[ImGuiKey_Y] = (int)Nz::Keyboard::Scancode::Y;
-        io.KeyMap[ImGuiKey_Z] = (int)Nz::Keyboard::Scancode::Z;
+        io.ConfigInputTrickleEventQueue = true;
 
         // Setup event handler
-        handler.OnMouseMoved.Connect([this](const Nz::WindowEventHandler*, const Nz::WindowEvent::MouseMoveEvent&) {
-            if (!m_bWindowHasFocus)
-                return;
+        handler.OnMouseMoved.Connect([this](const Nz::WindowEventHandler*, const Nz::WindowEvent::MouseMoveEvent& event) {
+            InputEvent inputEvent(InputEvent::Type::MousePos);
+            inputEvent.position = ImVec2(event.x * 1.f, event.y * 1.f);
+            PushInputEvent(inputEvent);
+        });
 
-            m_bMouseMoved = true;
+        handler.OnMouseLeft.Connect([this](const Nz::WindowEventHandler*) {
+            InputEvent inputEvent(InputEvent::Type::MousePos);
+            inputEvent.position = ImVec2(-FLT_MAX, -FLT_MAX);
+            PushInputEvent(inputEvent, false);
         });
 
-        handler.OnMouseButtonPressed.Connect([this](const Nz::WindowEventHandler*, const Nz::WindowEvent::MouseButtonEvent& event) {
-            if (!m_bWindowHasFocus)
+        auto pushMouseButtonEvent = [this](const Nz::WindowEvent::MouseButtonEvent& event, bool down) {
+            int button = ToImGui(event.button);
+            if (button < 0)
                 return;
 
-            if (event.button >= Nz::Mouse::Button::Left
-                && event.button <= Nz::Mouse::Button::Right)
-            {
-                ImGuiIO& io = ImGui::GetIO();
-                io.MouseDown[event.button] = true;
-            }
-        });
+            InputEvent inputEvent(InputEvent::Type::MouseButton);
+            inputEvent.code = button;
+            inputEvent.down = down;
+            PushInputEvent(inputEvent);
+        };
 
-        handler.OnMouseButtonReleased.Connect([this](const Nz::WindowEventHandler*, const Nz::WindowEvent::MouseButtonEvent& event) {
-            if (!m_bWindowHasFocus)
-                return;
+        handler.OnMouseButtonPressed.Connect([pushMouseButtonEvent](const Nz::WindowEventHandler*, const Nz::WindowEvent::MouseButtonEvent& event) {
+            pushMouseButtonEvent(event, true);
+        });
 
-            if (event.button >= Nz::Mouse::Button::Left
-                && event.button <= Nz::Mouse::Button::Right)
-            {
-                ImGuiIO& io = ImGui::GetIO();
-                io.MouseDown[event.button] = false;
-            }
+        handler.OnMouseButtonReleased.Connect([pushMouseButtonEvent](const Nz::WindowEventHandler*, const Nz::WindowEvent::MouseButtonEvent& event) {
+            pushMouseButtonEvent(event, false);
         });
 
         handler.OnMouseWheelMoved.Connect([this](const Nz::WindowEventHandler*, const Nz::WindowEvent::MouseWheelEvent& event) {
-            if (!m_bWindowHasFocus)
-                return;
-
-            ImGuiIO& io = ImGui::GetIO();
-            io.MouseWheel += event.delta;
+            InputEvent inputEvent(InputEvent::Type::MouseWheel);
+            inputEvent.position = ImVec2(0.f, event.delta);
+            PushInputEvent(inputEvent);
         });
 
-        handler.OnKeyPressed.Connect([this](const Nz::WindowEventHandler*, const Nz::WindowEvent::KeyEvent& event) {
-            if (!m_bWindowHasFocus)
-                return;
+        auto pushKeyEvent = [this](const Nz::WindowEvent::KeyEvent& event, bool down) {
+            InputEvent inputEvent(InputEvent::Type::Key);
+            inputEvent.code = int(event.scancode);
+            inputEvent.down = down;
+            PushInputEvent(inputEvent);
+        };
 
-            ImGuiIO& io = ImGui::GetIO();
-            io.KeysDown[(int)event.scancode] = true;
+        handler.OnKeyPressed.Connect([pushKeyEvent](const Nz::WindowEventHandler*, const Nz::WindowEvent::KeyEvent& event) {
+            pushKeyEvent(event, true);
         });
 
-        handler.OnKeyReleased.Connect([this](const Nz::WindowEventHandler*, const Nz::WindowEvent::KeyEvent& event) {
-            if (!m_bWindowHasFocus)
-                return;
-
-            ImGuiIO& io = ImGui::GetIO();
-            io.KeysDown[(int)event.scancode] = false;
+        handler.OnKeyReleased.Connect([pushKeyEvent](const Nz::WindowEventHandler*, const Nz::WindowEvent::KeyEvent& event) {
+            pushKeyEvent(event, false);
         });
 
         handler.OnTextEntered.Connect([this](const Nz::WindowEventHandler*, const Nz::WindowEvent::TextEvent& event) {
-            if (!m_bWindowHasFocus)
-                return;
-
-            ImGuiIO& io = ImGui::GetIO();
-
             // Don't handle the event for unprintable characters
             if (event.character < ' ' || event.character == 127) {
                 return;
             }
 
-            io.AddInputCharacter(event.character);
+            InputEvent inputEvent(InputEvent::Type::Text);
+            inputEvent.code = int(event.character);
+            PushInputEvent(inputEvent);
         });
 
+        // focus events also update m_bWindowHasFocus, see PushInputEvent
         handler.OnGainedFocus.Connect([this](const Nz::WindowEventHandler*) {
-            m_bWindowHasFocus = true;
+            InputEvent inputEvent(InputEvent::Type::Focus);
+            inputEvent.down = true;
+            PushInputEvent(inputEvent, false);
         });
 
         handler.OnLostFocus.Connect([this](const Nz::WindowEventHandler*) {
-            m_bWindowHasFocus = false;
+            // imgui releases the keys and buttons which were held
+            InputEvent inputEvent(InputEvent::Type::Focus);
+            inputEvent.down = false;
+            PushInputEvent(inputEvent, false);
+        });
+
+        handler.OnResized.Connect([this](const Nz::WindowEventHandler*, const Nz::WindowEvent::SizeEvent&) {
+            WakeUp();
         });
     }
 
-    void Imgui::Update(const Nz::Vector2i& mousePosition, const Nz::Vector2ui& displaySize, float dt)
+    void Imgui::PushInputEvent(InputEvent& inputEvent, bool requiresFocus)
+    {
+        inputEvent.timestamp = std::chrono::steady_clock::now();
+
+        // the focus is checked and changed with the queue, so events are filtered by the focus the window had when they were pushed
+        std::lock_guard<std::mutex> lock(m_inputMutex);
+        if (inputEvent.type == InputEvent::Type::Focus)
+            m_bWindowHasFocus = inputEvent.down;
+        else if (requiresFocus && !m_bWindowHasFocus)
+            return;
+
+        m_inputEvents.push_back(inputEvent);
+        KeepActiveUntil(inputEvent.timestamp + m_idleSettleTime);
+    }
+
+    bool Imgui::ProcessInputEvents()
+    {
+        // events may be pushed by another thread than the one building the UI, they're handed over in one go
+        bool windowHasFocus;
+        {
+            std::lock_guard<std::mutex> lock(m_inputMutex);
+            std::swap(m_inputEvents, m_processedInputEvents);
+            windowHasFocus = m_bWindowHasFocus;
+        }
+
+        ImGuiIO& io = ImGui::GetIO();
+        for (const InputEvent& inputEvent : m_processedInputEvents)
+        {
+            // events come in the order they were pushed, timestamps only tell how long they waited
+            m_lastInputLatency = std::chrono::steady_clock::now() - inputEvent.timestamp;
+
+            switch (inputEvent.type)
+            {
+                case InputEvent::Type::Focus:
+                    io.AddFocusEvent(inputEvent.down);
+                    if (!inputEvent.down)
+                        m_keyModifiers = ImGuiKeyModFlags_None;
+                    break;
+
+                case InputEvent::Type::Key:
+                {
+                    Nz::Keyboard::Scancode scancode = static_cast<Nz::Keyboard::Scancode>(inputEvent.code);
+                    ImGuiKeyModFlags modifier = ToImGuiModifier(scancode);
+                    if (modifier != ImGuiKeyModFlags_None)
+                    {
+                        if (inputEvent.down)
+                            m_keyModifiers |= modifier;
+                        else
+                            m_keyModifiers &= ~modifier;
+
+                        io.AddKeyModsEvent(m_keyModifiers);
+                    }
+
+                    ImGuiKey key = ToImGui(scancode);
+                    if (key != ImGuiKey_None)
+                        io.AddKeyEvent(key, inputEvent.down);
+                    break;
+                }
+
+                case InputEvent::Type::MouseButton:
+                    io.AddMouseButtonEvent(inputEvent.code, inputEvent.down);
+                    break;
+
+                case InputEvent::Type::MousePos:
+                    io.AddMousePosEvent(inputEvent.position.x, inputEvent.position.y);
+                    break;
+
+                case InputEvent::Type::MouseWheel:
+                    io.AddMouseWheelEvent(inputEvent.position.x, inputEvent.position.y);
+                    break;
+
+                case InputEvent::Type::Text:
+                    io.AddInputCharacter(static_cast<unsigned int>(inputEvent.code));
+                    break;
+            }
+        }
+
+        m_processedInputEvents.clear();
+
+        return windowHasFocus;
+    }
+
+    void Imgui::Update(const Nz::Vector2ui& displaySize, float dt)
     {
         ImGuiIO& io = ImGui::GetIO();
         io.DisplaySize = ImVec2(displaySize.x * 1.f, displaySize.y * 1.f);
 
         io.DeltaTime = dt / 1000.f;
 
-        if (m_bWindowHasFocus) {
-            if (io.WantSetMousePos) {
-                Nz::Vector2i mousePos(static_cast<int>(io.MousePos.x),
-                    static_cast<int>(io.MousePos.y));
-                Nz::Mouse::SetPosition(mousePos);
-            }
-            else {
-                io.MousePos = ImVec2(mousePosition.x * 1.f, mousePosition.y * 1.f);
-            }
-        }
+        bool windowHasFocus = ProcessInputEvents();
 
-        // Update Ctrl, Shift, Alt, Super state
-        io.KeyCtrl = io.KeysDown[(int)Nz::Keyboard::Scancode::LControl] || io.KeysDown[(int)Nz::Keyboard::Scancode::RControl];
-        io.KeyAlt = io.KeysDown[(int)Nz::Keyboard::Scancode::LAlt] || io.KeysDown[(int)Nz::Keyboard::Scancode::RAlt];
-        io.KeyShift = io.KeysDown[(int)Nz::Keyboard::Scancode::LShift] || io.KeysDown[(int)Nz::Keyboard::Scancode::RShift];
-        io.KeySuper = io.KeysDown[(int)Nz::Keyboard::Scancode::LSystem] || io.KeysDown[(int)Nz::Keyboard::Scancode::RSystem];
+        if (windowHasFocus && io.WantSetMousePos) {
+            Nz::Vector2i mousePos(static_cast<int>(io.MousePos.x),
+                static_cast<int>(io.MousePos.y));
+            Nz::Mouse::SetPosition(mousePos);
+        }
 
         assert(io.Fonts->Fonts.Size > 0);  // You forgot to create and set up font
         // atlas (see createFontTexture)
@@ -280,7 +543,7 @@ namespace Nz
     void Imgui::Render(Nz::Swapchain* renderTarget, Nz::RenderResources& frame)
     {
         Render();
-        m_imguiDrawer.Prepare(frame);
+        PrepareDrawer(frame);
 
         frame.Execute([this, renderTarget, &frame](Nz::CommandBufferBuilder& builder) {
 
@@ -305,20 +568,220 @@ namespace Nz
 
     void Imgui::Render()
     {
-        for (auto* handler : m_handlers)
-            handler->OnRenderImgui();
+        if (m_bFrameSkipped)
+            return;
+
+        // handlers may add or remove handlers, which would invalidate the iteration, it's deferred until they all ran
+        m_bRunningHandlers = true;
+        Nz::CallOnExit applyHandlerChanges([&]
+        {
+            m_bRunningHandlers = false;
+            ApplyPendingHandlerChanges();
+        });
+
+        for (HandlerTiming& timing : m_handlers)
+        {
+            // a handler removed during this frame may already be destroyed
+            if (!m_pendingHandlerChanges.empty() && IsHandlerRemovalPending(timing.handler))
+                continue;
+
+            auto start = std::chrono::steady_clock::now();
+
+            ThrottledHandler* throttledHandler = nullptr;
+            std::chrono::nanoseconds refreshInterval = timing.handler->GetImguiRefreshInterval();
+            if (refreshInterval > std::chrono::nanoseconds::zero())
+            {
+                std::unique_ptr<ThrottledHandler>& throttledHandlerPtr = m_throttledHandlers[timing.handler];
+                if (!throttledHandlerPtr)
+                    throttledHandlerPtr = std::make_unique<ThrottledHandler>();
+
+                throttledHandler = throttledHandlerPtr.get();
+                if (start < throttledHandler->nextRefresh && throttledHandler->cache.IsReplayable())
+                {
+                    throttledHandler->cache.Replay();
+                    timing.replayCount++;
+                    continue;
+                }
+
+                throttledHandler->cache.BeginCapture();
+            }
+
+            timing.handler->OnRenderImgui();
+            RecordHandlerTime(timing, std::chrono::steady_clock::now() - start);
+
+            if (throttledHandler)
+            {
+                throttledHandler->cache.EndCapture();
+                throttledHandler->nextRefresh = start + refreshInterval;
+            }
+        }
+
+        applyHandlerChanges.CallAndReset();
 
         ImGui::Render();
+
+        m_lastFrameTime = std::chrono::steady_clock::now();
+
+        std::size_t frontSnapshot = m_frontSnapshot;
+        if (m_bSnapshotDrawData)
+        {
+            frontSnapshot = 1 - m_frontSnapshot;
+            m_drawDataSnapshots[frontSnapshot].Capture(*ImGui::GetDrawData());
+        }
+
+        std::lock_guard<std::mutex> lock(m_snapshotMutex);
+        m_frontSnapshot = frontSnapshot;
+        m_bDrawDataPending = true;
     }
 
-    void Imgui::AddHandler(ImguiHandler* handler)
+    void Imgui::PrepareDrawer(Nz::RenderResources& frame)
     {
-        m_handlers.insert(handler);
+        // the drawer only reads the draw data while preparing, the snapshot can be swapped right after
+        std::lock_guard<std::mutex> lock(m_snapshotMutex);
+
+        // released once this frame is done, the ones which may sample them were submitted before it
+        for (std::shared_ptr<Nz::Texture>& texture : m_releasedFontTextures)
+            frame.PushForRelease(std::move(texture));
+
+        m_releasedFontTextures.clear();
+
+        // nothing to read while the UI is idle, the drawer keeps what it prepared
+        bool drawDataPending = std::exchange(m_bDrawDataPending, false);
+        if (m_bIdleMode && !drawDataPending && m_imguiDrawer.ReusePreparedFrame())
+            return;
+
+        if (m_bSnapshotDrawData)
+        {
+            ImguiDrawDataSnapshot& snapshot = m_drawDataSnapshots[m_frontSnapshot];
+            m_imguiDrawer.Prepare(frame, snapshot.GetDrawData(), snapshot.GetFontTextureId());
+        }
+        else
+            m_imguiDrawer.Prepare(frame);
+    }
+
+    void Imgui::AddHandler(ImguiHandler* handler, int priority)
+    {
+        if (m_bRunningHandlers)
+        {
+            m_pendingHandlerChanges.push_back({ handler, priority, false });
+            return;
+        }
+
+        InsertHandler(handler, priority);
     }
 
     void Imgui::RemoveHandler(ImguiHandler* handler)
     {
-        m_handlers.erase(handler);
+        if (m_bRunningHandlers)
+        {
+            m_pendingHandlerChanges.push_back({ handler, 0, true });
+            return;
+        }
+
+        EraseHandler(handler);
+    }
+
+    void Imgui::InsertHandler(ImguiHandler* handler, int priority)
+    {
+        auto it = std::find_if(m_handlers.begin(), m_handlers.end(), [&](const HandlerTiming& timing) { return timing.handler == handler; });
+        if (it != m_handlers.end())
+        {
+            if (it->priority == priority)
+                return;
+
+            HandlerTiming timing = std::move(*it);
+            m_handlers.erase(it);
+
+            timing.priority = priority;
+            auto position = std::upper_bound(m_handlers.begin(), m_handlers.end(), priority, [](int value, const HandlerTiming& other) { return value < other.priority; });
+            m_handlers.insert(position, std::move(timing));
+            return;
+        }
+
+        // after handlers of the same priority, so the order stays the registration one
+        HandlerTiming timing;
+        timing.handler = handler;
+        timing.priority = priority;
+
+        auto position = std::upper_bound(m_handlers.begin(), m_handlers.end(), priority, [](int value, const HandlerTiming& other) { return value < other.priority; });
+        m_handlers.insert(position, std::move(timing));
+    }
+
+    void Imgui::EraseHandler(ImguiHandler* handler)
+    {
+        auto it = std::find_if(m_handlers.begin(), m_handlers.end(), [&](const HandlerTiming& timing) { return timing.handler == handler; });
+        if (it != m_handlers.end())
+            m_handlers.erase(it);
+
+        m_throttledHandlers.erase(handler);
+    }
+
+    bool Imgui::IsHandlerRemovalPending(const ImguiHandler* handler) const
+    {
+        // the last change queued for a handler is the one which will apply
+        for (auto it = m_pendingHandlerChanges.rbegin(); it != m_pendingHandlerChanges.rend(); ++it)
+        {
+            if (it->handler == handler)
+                return it->remove;
+        }
+
+        return false;
+    }
+
+    void Imgui::ApplyPendingHandlerChanges()
+    {
+        // changes are applied in the order they were made
+        for (const PendingHandlerChange& change : m_pendingHandlerChanges)
+        {
+            if (change.remove)
+                EraseHandler(change.handler);
+            else
+                InsertHandler(change.handler, change.priority);
+        }
+
+        m_pendingHandlerChanges.clear();
+    }
+
+    void Imgui::RefreshHandler(ImguiHandler* handler)
+    {
+        auto it = m_throttledHandlers.find(handler);
+        if (it != m_throttledHandlers.end())
+            it->second->cache.Clear();
+    }
+
+    void Imgui::SetHandlerBudget(ImguiHandler* handler, std::chrono::nanoseconds budget)
+    {
+        auto it = std::find_if(m_handlers.begin(), m_handlers.end(), [&](const HandlerTiming& timing) { return timing.handler == handler; });
+        if (it == m_handlers.end())
+            throw std::runtime_error("handler is not registered");
+
+        it->budget = budget;
+        it->overBudget = false;
+    }
+
+    void Imgui::RecordHandlerTime(HandlerTiming& timing, std::chrono::nanoseconds time)
+    {
+        constexpr long long AverageWeight = 16;
+
+        timing.lastTime = time;
+        timing.averageTime = (timing.callCount == 0) ? time : timing.averageTime + (time - timing.averageTime) / AverageWeight;
+        timing.maxTime = std::max(timing.maxTime, time);
+        timing.callCount++;
+
+        bool overBudget = timing.budget > std::chrono::nanoseconds::zero() && time > timing.budget;
+        if (overBudget)
+        {
+            timing.overBudgetCount++;
+
+            // only once per streak, a panel which is always too slow would flood the log otherwise
+            if (!timing.overBudget)
+            {
+                auto toMicroseconds = [](std::chrono::nanoseconds duration) { return std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()); };
+                NazaraWarning(std::string("Imgui handler \"") + timing.handler->GetImguiHandlerName() + "\" took " + toMicroseconds(time) + "us, over its budget of " + toMicroseconds(timing.budget) + "us");
+            }
+        }
+
+        timing.overBudget = overBudget;
     }
 
     void Imgui::SetClipboardText(void* userData, const char* text)
@@ -352,21 +815,176 @@ namespace Nz
         unsigned char* pixels;
         int width, height;
 
-        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        unsigned int bytesPerPixel = (m_bSingleChannelFontAtlas) ? 1 : 4;
+
+        // a new build includes the glyphs added so far, and keeps room for the next ones
+        bool rebuilding = (io.Fonts->TexPixelsAlpha8 == nullptr);
+        if (rebuilding)
+        {
+            m_glyphAtlas->ExtendGlyphRanges(*io.Fonts);
+            m_glyphAtlas->ReserveSpace(*io.Fonts, int(m_fontAtlasGlyphReserve.x), int(m_fontAtlasGlyphReserve.y));
+        }
+
+        // an atlas built from the same fonts on a previous run can be restored instead of rasterized
+        bool saveToCache = false;
+        Nz::UInt64 cacheKey = 0;
+        if (!m_fontAtlasCachePath.empty() && !io.Fonts->IsBuilt())
+        {
+            // building adds the default font to an empty atlas, do it first so the key covers it
+            if (io.Fonts->ConfigData.empty())
+                io.Fonts->AddFontDefault();
+
+            cacheKey = Nz::ImguiFontAtlasCache::ComputeKey(*io.Fonts, bytesPerPixel);
+            saveToCache = !Nz::ImguiFontAtlasCache::Load(m_fontAtlasCachePath, *io.Fonts, cacheKey, bytesPerPixel);
+        }
+
+        // the drawer samples a R8 font atlas as white with alpha, which is all the glyphs need
+        Nz::PixelFormat pixelFormat;
+        if (m_bSingleChannelFontAtlas)
+        {
+            io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+            pixelFormat = Nz::PixelFormat::R8;
+        }
+        else
+        {
+            io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+            pixelFormat = Nz::PixelFormat::RGBA8;
+        }
+
+        // the cache is only an optimization, failing to write it isn't an error
+        if (saveToCache)
+            Nz::ImguiFontAtlasCache::Save(m_fontAtlasCachePath, *io.Fonts, cacheKey, bytesPerPixel);
 
-        auto renderDevice = Nz::Graphics::Instance()->GetRenderDevice();
-        Nz::TextureInfo texParams;
-        texParams.width = width;
-        texParams.height = height;
-        texParams.pixelFormat = Nz::PixelFormat::RGBA8;
-        texParams.type = Nz::ImageType::E2D;
-        m_fontTexture = renderDevice->InstantiateTexture(texParams, pixels, true);
-        m_fontTexture->UpdateDebugName("FontTexture");
+        if (rebuilding)
+            m_glyphAtlas->Reset(*io.Fonts);
+
+        std::size_t rowSize = std::size_t(width) * bytesPerPixel;
+
+        // bands are compared through their fingerprint, the atlas can take tens of megabytes
+        constexpr int BandHeight = 32;
+        int bandCount = (height + BandHeight - 1) / BandHeight;
+
+        std::vector<Nz::UInt64> bandFingerprints(std::size_t(bandCount));
+        for (int band = 0; band < bandCount; ++band)
+        {
+            int y = band * BandHeight;
+            std::size_t size = std::size_t(std::min(BandHeight, height - y)) * rowSize;
+            bandFingerprints[band] = Nz::ImguiFingerprint::Compute(pixels + std::size_t(y) * rowSize, size);
+        }
+
+        if (m_fontTexture && m_fontTexture->GetSize() == Nz::Vector3ui(width, height, 1) && m_fontTexture->GetFormat() == pixelFormat && m_fontAtlasBandFingerprints.size() == bandFingerprints.size())
+        {
+            // glyph uvs are relative to the atlas size, which didn't change: upload the bands which differ from the last upload in place
+            // one band past the end flushes the last dirty range
+            int dirtyBegin = -1;
+            for (int band = 0; band <= bandCount; ++band)
+            {
+                int y = band * BandHeight;
+
+                bool dirty = false;
+                if (y < height)
+                    dirty = bandFingerprints[band] != m_fontAtlasBandFingerprints[band];
+
+                if (dirty && dirtyBegin < 0)
+                    dirtyBegin = y;
+                else if (!dirty && dirtyBegin >= 0)
+                {
+                    int dirtyEnd = std::min(y, height);
+                    if (!m_fontTexture->Update(pixels + std::size_t(dirtyBegin) * rowSize, Nz::Boxui(0, dirtyBegin, 0, width, dirtyEnd - dirtyBegin, 1), width))
+                        throw std::runtime_error("Failed to update font texture");
+
+                    // glyphs changed without the draw lists necessarily changing
+                    m_imguiDrawer.RequestRedraw();
+                    dirtyBegin = -1;
+                }
+            }
+        }
+        else
+        {
+            // first build, or the atlas overflowed its texture
+            if (m_fontTexture)
+            {
+                m_imguiDrawer.InvalidateTexture(m_fontTexture.get());
+
+                // frames in flight may still sample it, the next prepared frame releases it
+                std::lock_guard<std::mutex> lock(m_snapshotMutex);
+                m_releasedFontTextures.push_back(std::move(m_fontTexture));
+            }
+
+            auto renderDevice = Nz::Graphics::Instance()->GetRenderDevice();
+            Nz::TextureInfo texParams;
+            texParams.width = width;
+            texParams.height = height;
+            texParams.pixelFormat = pixelFormat;
+            texParams.type = Nz::ImageType::E2D;
+            m_fontTexture = renderDevice->InstantiateTexture(texParams, pixels, true);
+            m_fontTexture->UpdateDebugName("FontTexture");
+        }
+
+        m_fontAtlasBandFingerprints = std::move(bandFingerprints);
 
         ImTextureID textureID = m_fontTexture.get();
         io.Fonts->TexID = textureID;
     }
 
+    void Imgui::EnsureGlyphs(std::string_view text, ImFont* font)
+    {
+        ImGuiIO& io = ImGui::GetIO();
+        if (!font)
+            font = (io.FontDefault) ? io.FontDefault : (!io.Fonts->Fonts.empty()) ? io.Fonts->Fonts[0] : nullptr;
+
+        if (!font)
+            return;
+
+        std::vector<ImWchar> codepoints;
+        const char* textEnd = text.data() + text.size();
+        for (const char* it = text.data(); it < textEnd;)
+        {
+            unsigned int codepoint;
+            it += ImTextCharFromUtf8(&codepoint, it, textEnd);
+
+            // control characters aren't drawn, and codepoints the font doesn't have are only looked up once
+            if (codepoint < 0x20 || codepoint > IM_UNICODE_CODEPOINT_MAX)
+                continue;
+
+            if (font->FindGlyphNoFallback(static_cast<ImWchar>(codepoint)) || m_glyphAtlas->IsRequested(*font, static_cast<ImWchar>(codepoint)))
+                continue;
+
+            codepoints.push_back(static_cast<ImWchar>(codepoint));
+        }
+
+        if (codepoints.empty())
+            return;
+
+        std::vector<ImWchar>& pendingGlyphs = m_pendingGlyphs[font];
+        pendingGlyphs.insert(pendingGlyphs.end(), codepoints.begin(), codepoints.end());
+
+        RequestRedraw();
+    }
+
+    void Imgui::ProcessPendingGlyphs()
+    {
+        if (m_pendingGlyphs.empty())
+            return;
+
+        ImFontAtlas& atlas = *ImGui::GetIO().Fonts;
+
+        bool fits = true;
+        for (auto& [font, codepoints] : m_pendingGlyphs)
+        {
+            if (!m_glyphAtlas->AddGlyphs(atlas, *font, std::move(codepoints)))
+                fits = false;
+        }
+        m_pendingGlyphs.clear();
+
+        // the glyphs which didn't fit are part of the next build, which may need a bigger texture
+        if (!fits)
+            atlas.ClearTexData();
+
+        // only the bands the new glyphs were written to are uploaded
+        UpdateFontTexture();
+    }
+
     std::shared_ptr<Nz::Cursor> Imgui::GetMouseCursor(ImGuiMouseCursor cursorType)
     {
         return Nz::Cursor::Get(ToNz(cursorType));
@@ -485,4 +1103,117 @@ namespace ImGui
         draw_list->AddRectFilled(getTopLeftAbsolute(rect), getDownRightAbsolute(rect), ColorConvertFloat4ToU32(toImColor(color)), rounding, rounding_corners);
     }
 
+    /////////////// Renderer statistics
+    void NazaraRendererStats(bool* open)
+    {
+        if (!ImGui::Begin("Nazara renderer stats", open))
+        {
+            ImGui::End();
+            return;
+        }
+
+        const Nz::ImguiDrawer& drawer = Nz::Imgui::Instance()->GetImguiDrawer();
+        std::size_t frameCount = drawer.GetFrameStatsCount();
+        if (frameCount == 0)
+        {
+            ImGui::TextUnformatted("No frame drawn yet");
+            ImGui::End();
+            return;
+        }
+
+        auto toMilliseconds = [](std::chrono::nanoseconds duration) { return std::chrono::duration<float, std::milli>(duration).count(); };
+
+        // the frame being built isn't drawn yet, show the last one
+        const Nz::ImguiDrawer::FrameStats& stats = drawer.GetFrameStats();
+        ImGui::Text("Draw lists: %zu (%zu uploaded)", stats.drawListCount, stats.dirtyDrawListCount);
+        ImGui::Text("Vertices: %zu, indices: %zu", stats.vertexCount, stats.indexCount);
+        ImGui::Text("Draw calls: %zu", stats.drawCallCount);
+        ImGui::Text("Pipeline changes: %zu, shader binding changes: %zu", stats.pipelineChangeCount, stats.shaderBindingChangeCount);
+        ImGui::Text("Skipped state changes: %zu", stats.skippedStateChangeCount);
+        ImGui::Text("Uploaded: %.1f KiB", float(stats.uploadedBytes) / 1024.f);
+        ImGui::Text("Prepare: %.3f ms, draw: %.3f ms", toMilliseconds(stats.prepareTime), toMilliseconds(stats.drawTime));
+        if (stats.reused)
+            ImGui::TextUnformatted("Reused the previously prepared frame");
+        else if (!stats.changed)
+            ImGui::TextUnformatted("Unchanged, recorded commands may be submitted again");
+
+        // oldest first
+        std::array<float, Nz::ImguiDrawer::FrameStatsHistorySize> prepareTimes;
+        std::array<float, Nz::ImguiDrawer::FrameStatsHistorySize> drawTimes;
+        std::size_t reusedCount = 0;
+        std::size_t unchangedCount = 0;
+        for (std::size_t i = 0; i < frameCount; ++i)
+        {
+            const Nz::ImguiDrawer::FrameStats& frameStats = drawer.GetFrameStats(frameCount - i - 1);
+            prepareTimes[i] = toMilliseconds(frameStats.prepareTime);
+            drawTimes[i] = toMilliseconds(frameStats.drawTime);
+
+            if (frameStats.reused)
+                reusedCount++;
+            else if (!frameStats.changed)
+                unchangedCount++;
+        }
+
+        ImGui::Text("Last %zu frames: %zu reused, %zu unchanged", frameCount, reusedCount, unchangedCount);
+
+        ImGui::PlotLines("Prepare (ms)", prepareTimes.data(), int(frameCount), 0, nullptr, 0.f, FLT_MAX, ImVec2(0.f, 40.f));
+        ImGui::PlotLines("Draw (ms)", drawTimes.data(), int(frameCount), 0, nullptr, 0.f, FLT_MAX, ImVec2(0.f, 40.f));
+
+        ImGui::End();
+    }
+
+    void NazaraHandlerTimings(bool* open)
+    {
+        if (!ImGui::Begin("Nazara handler timings", open))
+        {
+            ImGui::End();
+            return;
+        }
+
+        auto toMilliseconds = [](std::chrono::nanoseconds duration) { return std::chrono::duration<float, std::milli>(duration).count(); };
+
+        // this window is drawn by a handler too, its own timings are the ones of the previous frame
+        const auto& timings = Nz::Imgui::Instance()->GetHandlerTimings();
+        if (ImGui::BeginTable("handlers", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Handler", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Priority");
+            ImGui::TableSetupColumn("Last (ms)");
+            ImGui::TableSetupColumn("Avg (ms)");
+            ImGui::TableSetupColumn("Max (ms)");
+            ImGui::TableSetupColumn("Budget (ms)");
+            ImGui::TableSetupColumn("Replayed");
+            ImGui::TableHeadersRow();
+
+            for (const Nz::Imgui::HandlerTiming& timing : timings)
+            {
+                ImGui::TableNextRow();
+                if (timing.overBudget)
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, IM_COL32(160, 40, 40, 255));
+
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(timing.handler->GetImguiHandlerName());
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", timing.priority);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", toMilliseconds(timing.lastTime));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", toMilliseconds(timing.averageTime));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", toMilliseconds(timing.maxTime));
+                ImGui::TableNextColumn();
+                if (timing.budget > std::chrono::nanoseconds::zero())
+                    ImGui::Text("%.3f (%zu over)", toMilliseconds(timing.budget), timing.overBudgetCount);
+                else
+                    ImGui::TextUnformatted("-");
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu / %zu", timing.replayCount, timing.replayCount + timing.callCount);
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+
 }  // end of namespace ImGui
@@ -0,0 +1,108 @@
+#include "Tests.hpp"
+
+#include <NazaraImgui/ImguiDrawListCompiler.hpp>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace Nz::Tests
+{
+	namespace
+	{
+		void AddQuads(ImDrawList& drawList, int quadCount, ImU32 color)
+		{
+			ImDrawCmd cmd;
+			cmd.ClipRect = ImVec4(0.f, 0.f, 1920.f, 1080.f);
+			cmd.TextureId = nullptr;
+			cmd.VtxOffset = 0;
+			cmd.IdxOffset = 0;
+			cmd.ElemCount = static_cast<unsigned int>(quadCount * 6);
+			cmd.UserCallback = nullptr;
+			drawList.CmdBuffer.push_back(cmd);
+
+			for (int i = 0; i < quadCount; ++i)
+			{
+				float x = float(i) * 10.f;
+
+				drawList.VtxBuffer.push_back(ImDrawVert{ ImVec2(x, 0.f), ImVec2(0.f, 0.f), color });
+				drawList.VtxBuffer.push_back(ImDrawVert{ ImVec2(x + 8.f, 0.f), ImVec2(1.f, 0.f), color });
+				drawList.VtxBuffer.push_back(ImDrawVert{ ImVec2(x + 8.f, 8.f), ImVec2(1.f, 1.f), color });
+				drawList.VtxBuffer.push_back(ImDrawVert{ ImVec2(x, 8.f), ImVec2(0.f, 1.f), color });
+
+				ImDrawIdx base = static_cast<ImDrawIdx>(i * 4);
+				for (ImDrawIdx index : { 0, 1, 2, 0, 2, 3 })
+					drawList.IdxBuffer.push_back(static_cast<ImDrawIdx>(base + index));
+			}
+		}
+	}
+
+	// Uploads a frame, changes one draw list and uploads the next one in the same memory:
+	// only the changed list may be written, the bytes of the others must be left as they were
+	void DrawListUploadTests()
+	{
+		constexpr int drawListCount = 3;
+		constexpr int quadCount = 16;
+		constexpr int changedDrawList = 1;
+
+		std::vector<std::unique_ptr<ImDrawList>> drawLists;
+		std::vector<ImDrawList*> drawListPointers;
+
+		ImDrawData drawData;
+		for (int i = 0; i < drawListCount; ++i)
+		{
+			auto& drawList = drawLists.emplace_back(std::make_unique<ImDrawList>(nullptr));
+			AddQuads(*drawList, quadCount, 0xFF000000 | ImU32(i));
+
+			drawListPointers.push_back(drawList.get());
+			drawData.TotalVtxCount += drawList->VtxBuffer.size();
+			drawData.TotalIdxCount += drawList->IdxBuffer.size();
+		}
+		drawData.Valid = true;
+		drawData.CmdListsCount = drawListCount;
+		drawData.CmdLists = drawListPointers.data();
+
+		// stands for the mapped gpu buffers, which keep their content between frames
+		std::vector<ImDrawVert> vertices(drawData.TotalVtxCount);
+		std::vector<ImDrawIdx> indices(drawData.TotalIdxCount);
+
+		ImguiDrawListCompiler compiler;
+		ImguiDrawListCompiler::UploadCache uploadCache;
+
+		// frame A, everything is uploaded
+		NAZARA_IMGUI_CHECK(compiler.PrepareDrawLists(drawData, uploadCache) == drawListCount);
+		compiler.UploadDrawLists(vertices.data(), indices.data(), uploadCache);
+
+		std::vector<ImDrawVert> verticesA = vertices;
+		std::vector<ImDrawIdx> indicesA = indices;
+
+		// same frame again, nothing to upload
+		NAZARA_IMGUI_CHECK(compiler.PrepareDrawLists(drawData, uploadCache) == 0);
+		NAZARA_IMGUI_CHECK(compiler.GetDirtyGeometrySize() == 0);
+
+		// frame B, one vertex of a single draw list changes
+		drawLists[changedDrawList]->VtxBuffer[0].col = 0xFFFFFFFF;
+
+		NAZARA_IMGUI_CHECK(compiler.PrepareDrawLists(drawData, uploadCache) == 1);
+		NAZARA_IMGUI_CHECK(compiler.GetDirtyGeometrySize() == drawLists[changedDrawList]->VtxBuffer.size() * sizeof(ImDrawVert) + drawLists[changedDrawList]->IdxBuffer.size() * sizeof(ImDrawIdx));
+		compiler.UploadDrawLists(vertices.data(), indices.data(), uploadCache);
+
+		std::size_t vertexOffset = 0;
+		std::size_t indexOffset = 0;
+		for (int i = 0; i < drawListCount; ++i)
+		{
+			const ImDrawList& drawList = *drawLists[i];
+			std::size_t vertexSize = drawList.VtxBuffer.size() * sizeof(ImDrawVert);
+			std::size_t indexSize = drawList.IdxBuffer.size() * sizeof(ImDrawIdx);
+
+			const ImDrawVert* expectedVertices = (i == changedDrawList) ? drawList.VtxBuffer.Data : &verticesA[vertexOffset];
+			const ImDrawIdx* expectedIndices = (i == changedDrawList) ? drawList.IdxBuffer.Data : &indicesA[indexOffset];
+
+			NAZARA_IMGUI_CHECK(std::memcmp(&vertices[vertexOffset], expectedVertices, vertexSize) == 0);
+			NAZARA_IMGUI_CHECK(std::memcmp(&indices[indexOffset], expectedIndices, indexSize) == 0);
+
+			vertexOffset += drawList.VtxBuffer.size();
+			indexOffset += drawList.IdxBuffer.size();
+		}
+	}
+}
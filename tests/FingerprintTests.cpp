@@ -0,0 +1,51 @@
+#include "Tests.hpp"
+
+#include <NazaraImgui/ImguiFingerprint.hpp>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace Nz::Tests
+{
+	// Every SIMD kernel the host supports has to match the scalar reference bit for bit,
+	// whatever the size (including the tail bytes) and the alignment of the data
+	void FingerprintTests()
+	{
+		constexpr std::size_t maxSize = 300;
+		constexpr std::size_t maxOffset = 64;
+		constexpr UInt64 seeds[] = { 0, 1, 0x9E3779B97F4A7C15ULL, 0xFFFFFFFFFFFFFFFFULL };
+
+		std::mt19937 rng(42);
+		std::vector<UInt8> buffer(maxOffset + maxSize);
+		for (UInt8& byte : buffer)
+			byte = static_cast<UInt8>(rng());
+
+		for (const ImguiFingerprint::Kernel& kernel : ImguiFingerprint::GetSupportedKernels())
+		{
+			std::printf("fingerprint kernel: %s\n", kernel.name);
+
+			for (UInt64 seed : seeds)
+			{
+				for (std::size_t offset = 0; offset < maxOffset; ++offset)
+				{
+					for (std::size_t size = 0; size <= maxSize; ++size)
+					{
+						const UInt8* data = buffer.data() + offset;
+
+						UInt64 expected = ImguiFingerprint::ComputeReference(data, size, seed);
+						if (!NAZARA_IMGUI_CHECK(ImguiFingerprint::ComputeWith(kernel.accumulate, data, size, seed) == expected))
+						{
+							std::fprintf(stderr, "kernel %s differs from the reference (size %zu, offset %zu, seed %llx)\n", kernel.name, size, offset, static_cast<unsigned long long>(seed));
+							return;
+						}
+					}
+				}
+			}
+		}
+
+		// the dispatched kernel is one of them
+		std::vector<UInt8> data(buffer.begin(), buffer.begin() + maxSize);
+		NAZARA_IMGUI_CHECK(ImguiFingerprint::Compute(data.data(), data.size(), 7) == ImguiFingerprint::ComputeReference(data.data(), data.size(), 7));
+	}
+}
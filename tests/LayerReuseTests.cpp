@@ -0,0 +1,105 @@
+#include "Tests.hpp"
+
+#include <NazaraImgui/ImguiDrawListCompiler.hpp>
+#include <NazaraImgui/ImguiLayerState.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace Nz::Tests
+{
+	namespace
+	{
+		// Prepares the draw data and tells whether it draws something else than the previously prepared one, as ImguiDrawer does
+		bool PrepareFrame(ImguiDrawListCompiler& compiler, ImguiDrawListCompiler::UploadCache& uploadCache, const ImDrawData& drawData, UInt64& previousFingerprint)
+		{
+			compiler.Clear();
+			compiler.PrepareDrawLists(drawData, uploadCache);
+			compiler.CompileCommands([](ImTextureID) -> ImguiDrawListCompiler::DrawState
+			{
+				return { nullptr, nullptr, nullptr };
+			}, ImVec2(1.f, 1.f));
+
+			UInt64 fingerprint = compiler.GetFrameFingerprint();
+			bool changed = fingerprint != previousFingerprint;
+			previousFingerprint = fingerprint;
+
+			return changed;
+		}
+	}
+
+	// Goes through the frames RenderLayer sees: the layer is only rendered again when the prepared frame changed,
+	// recreated when the framebuffer is resized and not composited when nothing was prepared
+	void LayerReuseTests()
+	{
+		using Update = ImguiLayerState::Update;
+
+		ImDrawList drawList(nullptr);
+
+		ImDrawCmd cmd;
+		cmd.ClipRect = ImVec4(0.f, 0.f, 1920.f, 1080.f);
+		cmd.TextureId = nullptr;
+		cmd.VtxOffset = 0;
+		cmd.IdxOffset = 0;
+		cmd.ElemCount = 6;
+		cmd.UserCallback = nullptr;
+		drawList.CmdBuffer.push_back(cmd);
+
+		drawList.VtxBuffer.push_back(ImDrawVert{ ImVec2(0.f, 0.f), ImVec2(0.f, 0.f), IM_COL32_WHITE });
+		drawList.VtxBuffer.push_back(ImDrawVert{ ImVec2(8.f, 0.f), ImVec2(1.f, 0.f), IM_COL32_WHITE });
+		drawList.VtxBuffer.push_back(ImDrawVert{ ImVec2(8.f, 8.f), ImVec2(1.f, 1.f), IM_COL32_WHITE });
+		drawList.VtxBuffer.push_back(ImDrawVert{ ImVec2(0.f, 8.f), ImVec2(0.f, 1.f), IM_COL32_WHITE });
+		for (ImDrawIdx index : { 0, 1, 2, 0, 2, 3 })
+			drawList.IdxBuffer.push_back(index);
+
+		ImDrawList* drawListPointer = &drawList;
+
+		ImDrawData drawData;
+		drawData.Valid = true;
+		drawData.CmdListsCount = 1;
+		drawData.CmdLists = &drawListPointer;
+		drawData.TotalVtxCount = drawList.VtxBuffer.size();
+		drawData.TotalIdxCount = drawList.IdxBuffer.size();
+
+		ImguiDrawListCompiler compiler;
+		ImguiDrawListCompiler::UploadCache uploadCache;
+		UInt64 previousFingerprint = 0;
+
+		ImguiLayerState layerState;
+		NAZARA_IMGUI_CHECK(!layerState.IsUpToDate());
+
+		Vector2i size(1920, 1080);
+
+		// first frame, the layer is created
+		bool changed = PrepareFrame(compiler, uploadCache, drawData, previousFingerprint);
+		NAZARA_IMGUI_CHECK(changed);
+		NAZARA_IMGUI_CHECK(layerState.Prepare(size, changed) == Update::Create);
+		NAZARA_IMGUI_CHECK(layerState.IsUpToDate());
+
+		// same frame, the layer is composited as-is
+		changed = PrepareFrame(compiler, uploadCache, drawData, previousFingerprint);
+		NAZARA_IMGUI_CHECK(!changed);
+		NAZARA_IMGUI_CHECK(layerState.Prepare(size, changed) == Update::Reuse);
+		NAZARA_IMGUI_CHECK(layerState.IsUpToDate());
+
+		// a vertex changes, the layer is rendered again
+		drawList.VtxBuffer[0].col = IM_COL32_BLACK;
+		changed = PrepareFrame(compiler, uploadCache, drawData, previousFingerprint);
+		NAZARA_IMGUI_CHECK(changed);
+		NAZARA_IMGUI_CHECK(layerState.Prepare(size, changed) == Update::Render);
+
+		changed = PrepareFrame(compiler, uploadCache, drawData, previousFingerprint);
+		NAZARA_IMGUI_CHECK(layerState.Prepare(size, changed) == Update::Reuse);
+
+		// resized framebuffer, the layer is created again even if the draw data didn't change
+		Vector2i resizedSize(1280, 720);
+		NAZARA_IMGUI_CHECK(layerState.Prepare(resizedSize, false) == Update::Create);
+		NAZARA_IMGUI_CHECK(layerState.Prepare(resizedSize, false) == Update::Reuse);
+
+		// nothing prepared (minimized window), what the layer held mustn't be composited nor reused afterwards
+		NAZARA_IMGUI_CHECK(layerState.Prepare(Vector2i(0, 0), false) == Update::None);
+		NAZARA_IMGUI_CHECK(!layerState.IsUpToDate());
+		NAZARA_IMGUI_CHECK(layerState.Prepare(resizedSize, false) == Update::Render);
+		NAZARA_IMGUI_CHECK(layerState.IsUpToDate());
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdio>
+
+/*
+    Tests.hpp
+    Minimal test harness: tests are plain functions listed in main.cpp, failed checks are reported and counted
+*/
+
+namespace Nz::Tests
+{
+	inline int s_failureCount = 0;
+
+	inline bool Check(bool result, const char* expression, const char* file, int line)
+	{
+		if (!result)
+		{
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+			s_failureCount++;
+		}
+
+		return result;
+	}
+
+	void DrawListUploadTests();
+	void FingerprintTests();
+	void LayerReuseTests();
+}
+
+#define NAZARA_IMGUI_CHECK(expr) Nz::Tests::Check((expr), #expr, __FILE__, __LINE__)
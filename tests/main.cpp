@@ -0,0 +1,28 @@
+#include "Tests.hpp"
+
+#include <cstdlib>
+
+int main()
+{
+	struct Test
+	{
+		const char* name;
+		void(*func)();
+	};
+
+	constexpr Test tests[] = {
+		{ "draw list upload", &Nz::Tests::DrawListUploadTests },
+		{ "fingerprint kernels", &Nz::Tests::FingerprintTests },
+		{ "layer reuse", &Nz::Tests::LayerReuseTests }
+	};
+
+	for (const Test& test : tests)
+	{
+		int failureCount = Nz::Tests::s_failureCount;
+		test.func();
+
+		std::printf("%-24s %s\n", test.name, (Nz::Tests::s_failureCount == failureCount) ? "ok" : "FAILED");
+	}
+
+	return (Nz::Tests::s_failureCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
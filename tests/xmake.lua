@@ -0,0 +1,17 @@
+option("tests")
+	set_default(false)
+	set_showmenu(true)
+	set_description("Build unit tests")
+option_end()
+
+if has_config("tests") then
+	target("NazaraImgui-tests")
+		set_group("Tests")
+		set_kind("binary")
+		add_files("*.cpp")
+		add_deps("NazaraImgui")
+
+		-- fingerprint kernels are private to the library
+		add_files("../src/NazaraImgui/ImguiFingerprint.cpp")
+		set_rundir(".")
+end
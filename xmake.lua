@@ -63,6 +63,10 @@ target("NazaraImgui")
 	add_headerfiles("src/NazaraImgui/**.inl", { prefixdir = "private", install = false })
 	add_files("src/NazaraImgui/**.cpp")
 
+	-- shaders are embedded precompiled, see xmake/rules/compile_shaders.lua
+	add_rules("compile.shaders")
+	add_files("src/NazaraImgui/Resources/*.nzsl")
+
 	-- for now only shared compilation is supported (except on platforms like wasm)
 	if not is_plat("wasm") then
 		set_kind("shared")
@@ -77,3 +81,5 @@ target("NazaraImgui")
 	end
 
 includes("examples/xmake.lua")
+includes("bench/xmake.lua")
+includes("tests/xmake.lua")
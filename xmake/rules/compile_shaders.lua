@@ -0,0 +1,37 @@
+-- Compiles .nzsl shaders to serialized NZSL modules (.nzslb.h, a list of bytes meant to be included in an array)
+-- so they don't have to be parsed at runtime. Options stay unresolved (partial compilation).
+rule("compile.shaders")
+	set_extensions(".nzsl")
+
+	on_config(function (target)
+		import("lib.detect.find_tool")
+
+		local paths = {}
+		local nzsl = target:pkg("nzsl")
+		if nzsl and nzsl:installdir() then
+			table.insert(paths, path.join(nzsl:installdir(), "bin"))
+		end
+
+		local nzslc = find_tool("nzslc", { paths = paths })
+		if not nzslc then
+			raise("nzslc was not found, it's required to compile shaders")
+		end
+
+		local outputdir = path.join(target:autogendir(), "shaders")
+		target:add("includedirs", outputdir)
+		target:data_set("nzslc", nzslc.program)
+		target:data_set("shader_output_dir", outputdir)
+	end)
+
+	before_buildcmd_file(function (target, batchcmds, shaderfile, opt)
+		local outputdir = target:data("shader_output_dir")
+		local outputfile = path.join(outputdir, path.filename(shaderfile) .. "b.h")
+
+		batchcmds:show_progress(opt.progress, "${color.build.object}compiling.shader %s", shaderfile)
+		batchcmds:mkdir(outputdir)
+		batchcmds:vrunv(target:data("nzslc"), { "--compile=nzslb-header", "--partial", "--optimize", "--output=" .. outputdir, shaderfile })
+
+		batchcmds:add_depfiles(shaderfile)
+		batchcmds:set_depmtime(os.mtime(outputfile))
+		batchcmds:set_depcache(target:dependfile(outputfile))
+	end)